@@ -0,0 +1,202 @@
+#include "Batch.hpp"
+#include <cmath>
+
+namespace slvr
+{
+    namespace batch
+    {
+        double BatchReport::ideal() const noexcept
+        {
+            return workers.empty() ? 0 : std::max(work / workers.size(), longest);
+        }
+
+        double BatchReport::efficiency() const noexcept
+        {
+            return makespan > 0 ? ideal() / makespan : 1;
+        }
+
+        // Exact distance where the table stores one, otherwise nothing.
+        static std::optional<byte> exact(pruning::TableId id, const CubieState& state)
+        {
+            std::shared_ptr<const pruning::PruningTable> table = pruning::table(id);
+
+            if (!table || table->encoding() != pruning::Encoding::NIBBLE) {return std::nullopt;}
+
+            byte v = table->stored(pruning::index(id, state));
+
+            return v == 15 ? std::nullopt : std::optional<byte>(v);
+        }
+
+        double difficulty(const Cube& cube)
+        {
+            CubieState s(cube);
+            byte flipped = 0, twisted = 0;
+
+            for (byte e : s.eo) {flipped += e;}
+            for (byte c : s.co) {twisted += c != 0;}
+
+            // A quarter turn of F or B flips four edges; any quarter turn off U/D twists four corners.
+            std::array<byte, 3> depth {static_cast<byte>((flipped + 3) / 4), static_cast<byte>((twisted + 3) / 4), 0};
+
+            for (byte g = 0; g < 3; ++g)
+            {
+                if (std::optional<byte> d = exact(pruning::phaseTable(g), s)) {depth[g] = *d;}
+            }
+
+            double cost = 0;
+
+            for (byte g = 0; g < 3; ++g) {cost += std::pow(phaseBranching[g], depth[g]);}
+
+            return cost;
+        }
+
+        struct Job
+        {
+            regi index;
+            double estimate;
+        };
+
+        struct Queue
+        {
+            std::mutex mtx;
+            std::deque<Job> jobs;  // most expensive first
+            double remaining = 0;  // estimated cost of jobs
+        };
+
+        // Takes the cheapest job of the queue with the most estimated work left, so the thief
+        // doesn't end up holding a long job at the end of the batch.
+        static std::optional<Job> steal(std::vector<Queue>& queues, regi thief)
+        {
+            while (true)
+            {
+                regi victim = queues.size();
+                double most = 0;
+
+                for (regi q = 0; q < queues.size(); ++q)
+                {
+                    if (q == thief) {continue;}
+
+                    std::lock_guard<std::mutex> lock(queues[q].mtx);
+
+                    if (!queues[q].jobs.empty() && (victim == queues.size() || queues[q].remaining > most))
+                    {
+                        victim = q;
+                        most = queues[q].remaining;
+                    }
+                }
+
+                if (victim == queues.size()) {return std::nullopt;}
+
+                std::lock_guard<std::mutex> lock(queues[victim].mtx);
+
+                // Emptied since it was chosen: look again.
+                if (queues[victim].jobs.empty()) {continue;}
+
+                Job job = queues[victim].jobs.back();
+
+                queues[victim].jobs.pop_back();
+                queues[victim].remaining -= job.estimate;
+
+                return job;
+            }
+        }
+
+        BatchResult solve(const std::vector<Cube>& cubes, const BatchConfig& config)
+        {
+            regi threads = std::max<regi>(std::min<regi>(config.threads, cubes.size()), 1);
+            BatchResult out;
+            std::vector<Queue> queues(threads);
+            std::vector<double> seconds(cubes.size(), 0);
+
+            out.results.resize(cubes.size());
+            out.report.workers.resize(threads);
+
+            if (config.schedule == Schedule::STATIC)
+            {
+                for (regi i = 0; i < cubes.size(); ++i) {queues[i * threads / cubes.size()].jobs.push_back(Job{i, 0});}
+            }
+            else
+            {
+                std::vector<Job> jobs;
+
+                jobs.reserve(cubes.size());
+
+                for (regi i = 0; i < cubes.size(); ++i) {jobs.push_back(Job{i, difficulty(cubes[i])});}
+
+                std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {return a.estimate > b.estimate;});
+
+                // Greedy LPT: each job goes to the worker with the least estimated work so far.
+                for (const Job& job : jobs)
+                {
+                    Queue& q = *std::min_element(queues.begin(), queues.end(), [](const Queue& a, const Queue& b) {return a.remaining < b.remaining;});
+
+                    q.jobs.push_back(job);
+                    q.remaining += job.estimate;
+                }
+            }
+
+            Clock::time_point start = Clock::now();
+            std::vector<std::thread> workers;
+
+            workers.reserve(threads);
+
+            for (regi w = 0; w < threads; ++w)
+            {
+                workers.emplace_back([&, w]
+                {
+                    WorkerStats& stats = out.report.workers[w];
+
+                    while (!config.token.cancelled())
+                    {
+                        std::optional<Job> job;
+
+                        {
+                            std::lock_guard<std::mutex> lock(queues[w].mtx);
+
+                            if (!queues[w].jobs.empty())
+                            {
+                                job = queues[w].jobs.front();
+                                queues[w].jobs.pop_front();
+                                queues[w].remaining -= job->estimate;
+                            }
+                        }
+
+                        if (!job && config.schedule == Schedule::LPT)
+                        {
+                            job = steal(queues, w);
+
+                            if (job) {++stats.stolen;}
+                        }
+
+                        if (!job) {return;}
+
+                        SearchLimits limits;
+
+                        limits.token = config.token;
+
+                        if (config.budget != Clock::duration::zero()) {limits.deadline = Deadline::after(config.budget);}
+
+                        Clock::time_point begin = Clock::now();
+
+                        out.results[job->index] = thistlethwaite::solve(cubes[job->index], limits, config.options);
+                        seconds[job->index] = std::chrono::duration<double>(Clock::now() - begin).count();
+                        stats.busy += seconds[job->index];
+                        ++stats.jobs;
+                    }
+                });
+            }
+
+            for (auto& t : workers) {t.join();}
+
+            out.report.makespan = std::chrono::duration<double>(Clock::now() - start).count();
+
+            for (double s : seconds)
+            {
+                out.report.work += s;
+                out.report.longest = std::max(out.report.longest, s);
+            }
+
+            return out;
+        }
+    }
+}
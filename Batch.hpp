@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Solver.hpp"
+#include <deque>
+
+namespace slvr
+{
+    // Solving many independent cubes on a fixed set of threads. Solve times vary by orders of
+    // magnitude, so jobs are ordered by an estimate of their cost up front: each worker starts on
+    // the most expensive jobs and idle workers steal from whoever has the most work left.
+    namespace batch
+    {
+        // Effective branching factors of the phase searches after same-face pruning.
+        constexpr const std::array<double, 3> phaseBranching {13.35, 10.4, 7.3};
+
+        enum class Schedule : byte
+        {
+            STATIC,  // equal contiguous slices in input order, no stealing
+            LPT      // longest expected first, then work stealing
+        };
+
+        struct BatchConfig
+        {
+            regi threads = std::thread::hardware_concurrency();
+            Schedule schedule = Schedule::LPT;
+            Clock::duration budget = Clock::duration::zero();  // per cube, zero for none
+            CancellationToken token;
+            thistlethwaite::SolveOptions options{false, false, true, 1};  // improve would spend each budget in full
+        };
+
+        struct WorkerStats
+        {
+            regi jobs     = 0;
+            regi stolen   = 0;
+            double busy   = 0;  // seconds spent solving
+        };
+
+        struct BatchReport
+        {
+            double makespan   = 0;  // seconds from start until the last worker finished
+            double work       = 0;  // seconds of solving summed over every job
+            double longest    = 0;  // seconds taken by the slowest job
+            std::vector<WorkerStats> workers;
+
+            // No schedule can beat the work spread evenly, nor the slowest single job.
+            [[nodiscard]] double ideal() const noexcept;
+            [[nodiscard]] double efficiency() const noexcept;
+        };
+
+        struct BatchResult
+        {
+            std::vector<thistlethwaite::SolveResult> results;  // in input order
+            BatchReport report;
+        };
+
+        // Relative cost estimate from the phase-table distances at the start: a search d moves deep
+        // costs about b^d nodes for branching factor b. Phases after the first are looked up on the
+        // unsolved cube, which only bounds them loosely; where a table isn't stored exactly the count
+        // of misoriented edges or corners stands in.
+        [[nodiscard]] double difficulty(const Cube& cube);
+
+        [[nodiscard]] BatchResult solve(const std::vector<Cube>& cubes, const BatchConfig& config = {});
+    }
+}
@@ -0,0 +1,388 @@
+#include "Benchmark.hpp"
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define BENCH_FILE "Could not write benchmark report"
+
+namespace slvr
+{
+    namespace bench
+    {
+        const char* name(Counter counter) noexcept
+        {
+            switch (counter)
+            {
+                case Counter::CYCLES:        return "cycles";
+                case Counter::INSTRUCTIONS:  return "instructions";
+                case Counter::L1D_MISSES:    return "l1dMisses";
+                case Counter::LLC_MISSES:    return "llcMisses";
+                case Counter::BRANCH_MISSES: return "branchMisses";
+            }
+
+            return "";
+        }
+
+#ifdef __linux__
+        static int openCounter(Counter counter) noexcept
+        {
+            perf_event_attr attr{};
+
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            switch (counter)
+            {
+                case Counter::CYCLES:        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES;    break;
+                case Counter::INSTRUCTIONS:  attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS;  break;
+                case Counter::LLC_MISSES:    attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES;  break;
+                case Counter::BRANCH_MISSES: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+                case Counter::L1D_MISSES:
+                    attr.type = PERF_TYPE_HW_CACHE;
+                    attr.config = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+                    break;
+            }
+
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+
+        CounterSet::CounterSet() noexcept
+        {
+            for (byte c = 0; c < numCounters; ++c)
+            {
+#ifdef __linux__
+                fds_[c] = openCounter(static_cast<Counter>(c));
+#else
+                fds_[c] = -1;
+#endif
+            }
+        }
+
+        CounterSet::~CounterSet()
+        {
+#ifdef __linux__
+            for (int fd : fds_)
+            {
+                if (fd >= 0) {close(fd);}
+            }
+#endif
+        }
+
+        bool CounterSet::available() const noexcept
+        {
+            return std::any_of(fds_.begin(), fds_.end(), [](int fd) {return fd >= 0;});
+        }
+
+        void CounterSet::start() noexcept
+        {
+#ifdef __linux__
+            for (int fd : fds_)
+            {
+                if (fd < 0) {continue;}
+
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        CounterValues CounterSet::stop() noexcept
+        {
+            CounterValues values{};
+
+#ifdef __linux__
+            for (byte c = 0; c < numCounters; ++c)
+            {
+                if (fds_[c] < 0) {continue;}
+
+                ioctl(fds_[c], PERF_EVENT_IOC_DISABLE, 0);
+
+                // value, time enabled, time running
+                std::array<std::uint64_t, 3> sample{};
+
+                if (read(fds_[c], sample.data(), sizeof(sample)) != static_cast<ssize_t>(sizeof(sample)) || sample[2] == 0) {continue;}
+
+                values[c] = sample[2] == sample[1] ? sample[0] : static_cast<std::uint64_t>(static_cast<double>(sample[0]) * sample[1] / sample[2]);
+            }
+#endif
+
+            return values;
+        }
+
+        double KernelStats::nodesPerSecond() const noexcept
+        {
+            return seconds > 0 ? nodes / seconds : 0;
+        }
+
+        std::optional<double> KernelStats::perNode(Counter counter) const noexcept
+        {
+            const std::optional<std::uint64_t>& value = counters[static_cast<byte>(counter)];
+
+            if (!value || nodes == 0) {return std::nullopt;}
+
+            return static_cast<double>(*value) / nodes;
+        }
+
+        double ExpansionReport::speedup() const noexcept
+        {
+            double base = plain.nodesPerSecond();
+
+            return base > 0 ? pipelined.nodesPerSecond() / base : 0;
+        }
+
+        // Counts every generated node: the kernel tests each child against the goal exactly once.
+        template <class Goal>
+        struct Counting
+        {
+            Goal goal;
+            regi* nodes;
+
+            [[nodiscard]] bool operator()(const CubieState& s) const noexcept
+            {
+                ++*nodes;
+
+                return goal(s);
+            }
+        };
+
+        struct Workload
+        {
+            CubieState start;
+            regi depth;
+        };
+
+        // Never satisfied, so every search exhausts its tree and both runs generate the same nodes.
+        struct Never
+        {
+            [[nodiscard]] constexpr bool operator()(const CubieState&) const noexcept {return false;}
+        };
+
+        // Hides locate() and lookup(), so the kernel reads each child's entry as it comes to it
+        // instead of prefetching all of a node's entries first.
+        template <class Heuristic>
+        struct Unpipelined
+        {
+            const Heuristic& heuristic;
+
+            [[nodiscard]] byte initial(const CubieState& s) const {return heuristic.initial(s);}
+            [[nodiscard]] byte next(const CubieState& s, byte parent) const noexcept {return heuristic.next(s, parent);}
+        };
+
+        static std::vector<Cube> positions(const BenchmarkConfig& config)
+        {
+            std::mt19937 rng(config.seed);
+            std::vector<Cube> out;
+
+            for (regi p = 0; p < config.positions; ++p)
+            {
+                Cube cube;
+
+                for (regi i = 0; i < config.scrambleLength; ++i)
+                {
+                    Move move;
+
+                    do {move = search::allMoves[rng() % 18];} while (cube.pruneMove(move));
+
+                    cube += move;
+                }
+
+                out.emplace_back(cube.cornerPositions(), cube.cornerOrientations(), cube.edgePositions(), cube.edgeOrientations());
+            }
+
+            return out;
+        }
+
+        template <const auto& Moves, class Heuristic>
+        static ExpansionReport measure(std::string name, const std::vector<Workload>& work, const Heuristic& heuristic, CounterSet* counters)
+        {
+            ExpansionReport report{std::move(name), {}, {}};
+            std::atomic<bool> solutionFound(false);
+            SearchLimits limits;
+            std::vector<Move> path;
+
+            auto time = [&](KernelStats& stats, auto kernel)
+            {
+                Counting<Never> counting{Never(), &stats.nodes};
+
+                if (counters) {counters->start();}
+
+                Clock::time_point begin = Clock::now();
+
+                for (const Workload& w : work)
+                {
+                    SearchContext ctx(solutionFound, limits);
+
+                    static_cast<void>(kernel(w, path, ctx, counting));
+                }
+
+                stats.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+                if (counters) {stats.counters = counters->stop();}
+            };
+
+            time(report.plain, [&](const Workload& w, std::vector<Move>& p, SearchContext& ctx, const Counting<Never>& goal)
+            {
+                return search::run<Moves>(w.start, w.depth, Face::NULL_FACE, Face::NULL_FACE, p, ctx, goal, Unpipelined<Heuristic>{heuristic});
+            });
+
+            time(report.pipelined, [&](const Workload& w, std::vector<Move>& p, SearchContext& ctx, const Counting<Never>& goal)
+            {
+                return search::run<Moves>(w.start, w.depth, Face::NULL_FACE, Face::NULL_FACE, p, ctx, goal, heuristic);
+            });
+
+            return report;
+        }
+
+        template <thistlethwaite::State G>
+        static ExpansionReport phase(const std::vector<Cube>& cubes, const BenchmarkConfig& config, CounterSet* counters)
+        {
+            using namespace thistlethwaite;
+
+            const pruning::Heuristic heuristic = pruning::heuristic(pruning::phaseTable(static_cast<byte>(G)));
+            std::vector<Workload> work;
+
+            for (const Cube& cube : cubes)
+            {
+                // The phase-optimal solution of the earlier phases leads to the start of this one.
+                SolveResult result = thistlethwaite::solve(cube, {}, SolveOptions{false, false, false, 1});
+                CubieState s(cube);
+
+                for (Move move : result.solution)
+                {
+                    if (static_cast<byte>(state(s)) >= static_cast<byte>(G)) {break;}
+
+                    search::apply(s, move);
+                }
+
+                work.push_back(Workload{s, heuristic.initial(s) + config.phaseSlack});
+            }
+
+            return measure<validMoves<G>()>("phase " + std::to_string(static_cast<int>(G)), work, heuristic, counters);
+        }
+
+        // Puts back the caller's table selection when the optimal run has switched it.
+        struct RestoreTables
+        {
+            const pruning::TableConfig saved = pruning::currentConfig();
+
+            ~RestoreTables() {pruning::configure(saved);}
+        };
+
+        std::vector<ExpansionReport> expansion(const BenchmarkConfig& config)
+        {
+            using thistlethwaite::State;
+
+            std::vector<Cube> cubes = positions(config);
+            std::vector<ExpansionReport> reports;
+            std::optional<CounterSet> counters;
+
+            if (config.counters) {counters.emplace();}
+
+            CounterSet* active = counters && counters->available() ? &*counters : nullptr;
+
+            pruning::prepare();
+
+            reports.push_back(phase<State::G0>(cubes, config, active));
+            reports.push_back(phase<State::G1>(cubes, config, active));
+            reports.push_back(phase<State::G2>(cubes, config, active));
+            reports.push_back(phase<State::G3>(cubes, config, active));
+
+            if (config.optimal)
+            {
+                const RestoreTables restore;
+                pruning::TableConfig tables;
+                tables.optimal = true;
+                pruning::configure(tables);
+
+                const pruning::Heuristic heuristic = pruning::heuristic(pruning::TableId::CORNERS);
+                std::vector<Workload> work;
+
+                for (const Cube& cube : cubes) {work.push_back(Workload{CubieState(cube), config.optimalDepth});}
+
+                reports.push_back(measure<thistlethwaite::g0Moves>("optimal", work, heuristic, active));
+            }
+
+            return reports;
+        }
+
+        static void write(std::ostream& os, const KernelStats& stats)
+        {
+            os << "{\"nodes\":" << stats.nodes << ",\"seconds\":" << stats.seconds << ",\"nodesPerSecond\":" << stats.nodesPerSecond();
+
+            for (byte c = 0; c < numCounters; ++c)
+            {
+                Counter counter = static_cast<Counter>(c);
+                const std::optional<std::uint64_t>& value = stats.counters[c];
+                std::optional<double> perNode = stats.perNode(counter);
+
+                os << ",\"" << name(counter) << "\":";
+
+                if (value) {os << *value;} else {os << "null";}
+
+                os << ",\"" << name(counter) << "PerNode\":";
+
+                if (perNode) {os << *perNode;} else {os << "null";}
+            }
+
+            os << '}';
+        }
+
+        std::string json(const std::vector<ExpansionReport>& reports)
+        {
+            std::ostringstream os;
+
+            os << std::setprecision(6) << "{\"expansion\":[";
+
+            for (regi i = 0; i < reports.size(); ++i)
+            {
+                const ExpansionReport& r = reports[i];
+
+                os << (i ? "," : "") << "{\"search\":\"" << r.search << "\",\"plain\":";
+                write(os, r.plain);
+                os << ",\"pipelined\":";
+                write(os, r.pipelined);
+                os << ",\"speedup\":" << r.speedup() << '}';
+            }
+
+            os << "]}";
+
+            return os.str();
+        }
+
+        void dump(const std::vector<ExpansionReport>& reports, const std::string& path)
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+            if (!out) {throw std::runtime_error(BENCH_FILE);}
+
+            out << json(reports);
+
+            if (!out) {throw std::runtime_error(BENCH_FILE);}
+        }
+
+        std::ostream& operator<<(std::ostream& os, const ExpansionReport& report)
+        {
+            std::ios_base::fmtflags flags = os.flags();
+
+            os << std::left << std::setw(10) << report.search << std::right << std::fixed << std::setprecision(2)
+               << " plain " << std::setw(12) << report.plain.nodes << " nodes " << std::setw(8) << report.plain.nodesPerSecond() / 1e6 << " Mn/s"
+               << " | pipelined " << std::setw(12) << report.pipelined.nodes << " nodes " << std::setw(8) << report.pipelined.nodesPerSecond() / 1e6 << " Mn/s"
+               << " | x" << report.speedup();
+            os.flags(flags);
+
+            return os;
+        }
+    }
+}
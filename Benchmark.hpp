@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Solver.hpp"
+#include <optional>
+#include <string>
+
+namespace slvr
+{
+    // Throughput measurements of the search kernel on reproducible random positions.
+    namespace bench
+    {
+        struct BenchmarkConfig
+        {
+            regi positions        = 20;
+            regi scrambleLength   = 30;
+            std::uint32_t seed    = 1;
+            regi phaseSlack       = 2;      // phase searches go this far beyond the table distance
+            bool optimal          = false;  // also measure the corner-table search (builds that table for the run)
+            regi optimalDepth     = 10;
+            bool counters         = false;  // read hardware counters around each measurement
+        };
+
+        enum class Counter : byte
+        {
+            CYCLES,
+            INSTRUCTIONS,
+            L1D_MISSES,
+            LLC_MISSES,
+            BRANCH_MISSES
+        };
+
+        constexpr const byte numCounters = 5;
+
+        [[nodiscard]] const char* name(Counter counter) noexcept;
+
+        // Unset where the counter could not be read.
+        using CounterValues = std::array<std::optional<std::uint64_t>, numCounters>;
+
+        // Hardware counters of the calling thread through perf_event_open, user space only. Each
+        // counter is opened on its own, so those the kernel refuses (no PMU, perf_event_paranoid,
+        // not Linux) are simply missing. Values are scaled up if the kernel multiplexed them.
+        class CounterSet
+        {
+        private:
+            std::array<int, numCounters> fds_;
+
+        public:
+            CounterSet() noexcept;
+            CounterSet(const CounterSet&) = delete;
+            CounterSet& operator=(const CounterSet&) = delete;
+            ~CounterSet();
+
+            [[nodiscard]] bool available() const noexcept;
+
+            void start() noexcept;
+            [[nodiscard]] CounterValues stop() noexcept;
+        };
+
+        struct KernelStats
+        {
+            regi nodes     = 0;
+            double seconds = 0;
+            CounterValues counters{};
+
+            [[nodiscard]] double nodesPerSecond() const noexcept;
+            [[nodiscard]] std::optional<double> perNode(Counter counter) const noexcept;
+        };
+
+        struct ExpansionReport
+        {
+            std::string search;
+            KernelStats plain;      // table entries read child by child
+            KernelStats pipelined;  // all of a node's entries prefetched before any is read
+
+            [[nodiscard]] double speedup() const noexcept;
+        };
+
+        // Times each phase search (and the optimal search if configured) through search::run with
+        // and without prefetching. The goal is never reached, so every search exhausts its
+        // depth-limited tree and both runs generate the same nodes.
+        [[nodiscard]] std::vector<ExpansionReport> expansion(const BenchmarkConfig& config = {});
+
+        // Reports as a JSON object, with counters both raw and per generated node. Missing counters
+        // are null.
+        [[nodiscard]] std::string json(const std::vector<ExpansionReport>& reports);
+        void dump(const std::vector<ExpansionReport>& reports, const std::string& path);
+
+        std::ostream& operator<<(std::ostream& os, const ExpansionReport& report);
+    }
+}
@@ -0,0 +1,458 @@
+#include "Corpus.hpp"
+#include "StateSet.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define CORPUS_IO "Corpus file error"
+#define CORPUS_MANIFEST "Corpus manifest does not match the job or its output file"
+
+namespace slvr
+{
+    namespace corpus
+    {
+        namespace fs = std::filesystem;
+
+        static std::string manifestPath(const CorpusConfig& config)
+        {
+            return config.manifestPath.empty() ? config.outputPath + ".manifest" : config.manifestPath;
+        }
+
+        // Forces a file, or a directory after a rename in it, to disk.
+        static void sync(const fs::path& path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0) {throw std::runtime_error(CORPUS_IO);}
+
+            int rc = ::fsync(fd);
+
+            ::close(fd);
+
+            if (rc != 0) {throw std::runtime_error(CORPUS_IO);}
+        }
+
+        static void save(const CorpusConfig& config, const CorpusStats& s)
+        {
+            fs::path path = manifestPath(config), tmp = path.string() + ".tmp";
+
+            {
+                std::ofstream out(tmp, std::ios::trunc);
+
+                out << "input " << static_cast<int>(config.input) << "\noutput " << static_cast<int>(config.output)
+                    << "\nchunkSize " << config.chunkSize << "\nchunks " << s.chunks << "\noffset " << s.inputOffset
+                    << "\nlength " << s.outputLength << "\nstates " << s.states << "\nsolved " << s.solved
+                    << "\npartial " << s.partial << "\ninvalid " << s.invalid << "\nduplicates " << s.duplicates
+                    << "\nfinished " << s.finished << '\n';
+
+                if (!out) {throw std::runtime_error(CORPUS_IO);}
+            }
+
+            sync(tmp);
+            fs::rename(tmp, path);
+            sync(path.has_parent_path() ? path.parent_path() : fs::path("."));
+        }
+
+        static bool load(const CorpusConfig& config, CorpusStats& s)
+        {
+            std::ifstream in(manifestPath(config));
+
+            if (!in) {return false;}
+
+            std::string key;
+            int input = 0, output = 0;
+            regi chunkSize = 0;
+
+            in >> key >> input >> key >> output >> key >> chunkSize >> key >> s.chunks >> key >> s.inputOffset
+               >> key >> s.outputLength >> key >> s.states >> key >> s.solved >> key >> s.partial
+               >> key >> s.invalid >> key >> s.duplicates >> key >> s.finished;
+
+            if (!in || input != static_cast<int>(config.input) || output != static_cast<int>(config.output) || chunkSize != config.chunkSize)
+            {
+                throw std::runtime_error(CORPUS_MANIFEST);
+            }
+
+            return true;
+        }
+
+        // One chunk's results, encoded and ready to append, with the totals it adds.
+        struct Encoded
+        {
+            std::string data;
+            CorpusStats delta;
+        };
+
+        class ChunkReader
+        {
+        private:
+            std::ifstream in_;
+            InputFormat format_;
+            std::uint64_t offset_;
+
+        public:
+            ChunkReader(const std::string& path, InputFormat format, std::uint64_t offset) :
+                in_(path, std::ios::binary),
+                format_(format),
+                offset_(offset)
+            {
+                if (!in_) {throw std::runtime_error(CORPUS_IO);}
+
+                in_.seekg(static_cast<std::streamoff>(offset));
+            }
+
+            // Whether every whitespace-separated token of line is a move: a face letter, optionally
+            // followed by ' or 2. Cube's own parser skips anything else.
+            static bool scramble(const std::string& line)
+            {
+                std::istringstream tokens(line);
+                std::string token;
+
+                while (tokens >> token)
+                {
+                    if (token.size() > 2 || std::string("RLUDFBrludfb").find(token[0]) == std::string::npos) {return false;}
+                    if (token.size() == 2 && token[1] != '\'' && token[1] != '2') {return false;}
+                }
+
+                return true;
+            }
+
+            // Reads up to n inputs as packed states; invalid ones are flagged. Returns the offset
+            // just past the chunk.
+            std::uint64_t next(regi n, std::vector<PackedCube>& states, std::vector<bool>& valid)
+            {
+                states.clear();
+                valid.clear();
+
+                if (format_ == InputFormat::PACKED)
+                {
+                    std::vector<byte> buf(n * packedCubeSize);
+
+                    in_.read(reinterpret_cast<char*>(buf.data()), buf.size());
+
+                    regi count = static_cast<regi>(in_.gcount()) / packedCubeSize;
+
+                    for (regi i = 0; i < count; ++i)
+                    {
+                        PackedCube packed = readPacked(buf.data() + i * packedCubeSize);
+                        bool ok = true;
+
+                        try {static_cast<void>(unpack(packed));}
+                        catch (const std::invalid_argument&) {ok = false;}
+
+                        states.push_back(packed);
+                        valid.push_back(ok);
+                    }
+
+                    offset_ += count * packedCubeSize;
+
+                    return offset_;
+                }
+
+                std::string line;
+
+                while (states.size() < n && std::getline(in_, line))
+                {
+                    offset_ += line.size() + (in_.eof() ? 0 : 1);
+
+                    if (!line.empty() && line.back() == '\r') {line.pop_back();}
+
+                    bool ok = scramble(line);
+
+                    states.push_back(pack(ok ? Cube(line) : Cube()));
+                    valid.push_back(ok);
+                }
+
+                return offset_;
+            }
+        };
+
+        static const char* statusName(protocol::Status status) noexcept
+        {
+            switch (status)
+            {
+                case protocol::Status::SOLVED:  return "solved";
+                case protocol::Status::PARTIAL: return "partial";
+                default:                        return "invalid";
+            }
+        }
+
+        // Solutions found in earlier chunks, so a state that recurs across chunks is solved once.
+        using Memo = std::unordered_map<PackedCube, std::vector<Move>, PackedCubeHash>;
+
+        static Encoded solveChunk(const CorpusConfig& config, regi base, const std::vector<PackedCube>& states, const std::vector<bool>& valid, Memo& memo)
+        {
+            std::vector<PackedCube> validStates;
+            std::vector<regi> slot(states.size(), 0);
+
+            for (regi i = 0; i < states.size(); ++i)
+            {
+                if (valid[i]) {slot[i] = validStates.size(); validStates.push_back(states[i]);}
+            }
+
+            Dedup d = dedup(validStates, config.threads);
+            std::vector<const std::vector<Move>*> known(d.unique.size(), nullptr);
+            std::vector<regi> job(d.unique.size(), 0);
+            std::vector<Cube> cubes;
+
+            for (regi u = 0; u < d.unique.size(); ++u)
+            {
+                auto it = memo.find(d.unique[u]);
+
+                if (it != memo.end()) {known[u] = &it->second;}
+                else {job[u] = cubes.size(); cubes.push_back(unpack(d.unique[u]));}
+            }
+
+            batch::BatchConfig batchConfig;
+
+            batchConfig.threads  = config.threads;
+            batchConfig.budget   = config.budget;
+            batchConfig.token    = config.token;
+            batchConfig.options  = config.options;
+
+            batch::BatchResult solved = batch::solve(cubes, batchConfig);
+            Encoded out;
+            std::ostringstream text;
+
+            out.delta.chunks = 1;
+            out.delta.states = states.size();
+            out.delta.duplicates = validStates.size() - cubes.size();
+
+            for (regi i = 0; i < states.size(); ++i)
+            {
+                protocol::Status status = protocol::Status::INVALID;
+                const std::vector<Move>* moves = nullptr;
+
+                if (valid[i] && known[d.representative[slot[i]]])
+                {
+                    status = protocol::Status::SOLVED;
+                    moves = known[d.representative[slot[i]]];
+                }
+                else if (valid[i])
+                {
+                    const thistlethwaite::SolveResult& r = solved.results[job[d.representative[slot[i]]]];
+
+                    status = r.solved ? protocol::Status::SOLVED : protocol::Status::PARTIAL;
+                    moves = &r.solution;
+                }
+
+                switch (status)
+                {
+                    case protocol::Status::SOLVED:  ++out.delta.solved;  break;
+                    case protocol::Status::PARTIAL: ++out.delta.partial; break;
+                    default:                        ++out.delta.invalid; break;
+                }
+
+                if (config.output == OutputFormat::BINARY)
+                {
+                    regi length = moves ? std::min<regi>(moves->size(), UCHAR_MAX) : 0;
+
+                    out.data.push_back(static_cast<char>(status));
+                    out.data.push_back(static_cast<char>(length));
+
+                    for (regi m = 0; m < length; ++m) {out.data.push_back(static_cast<char>((*moves)[m]));}
+
+                    continue;
+                }
+
+                text << base + i << ' ' << statusName(status);
+
+                if (moves) {for (Move move : *moves) {text << ' ' << move;}}
+
+                text << '\n';
+            }
+
+            if (config.output == OutputFormat::TEXT) {out.data = text.str();}
+
+            // Only complete solutions are kept; a partial one may finish on a later attempt.
+            for (regi u = 0; u < d.unique.size() && memo.size() < config.memoLimit; ++u)
+            {
+                if (!known[u] && solved.results[job[u]].solved) {memo.emplace(d.unique[u], solved.results[job[u]].solution);}
+            }
+
+            return out;
+        }
+
+        // Appends encoded chunks and commits each to the manifest, one chunk behind the solver.
+        class Writer
+        {
+        private:
+            const CorpusConfig& config_;
+            CorpusStats& stats_;
+            std::ofstream out_;
+            std::mutex mtx_;
+            std::condition_variable changed_;
+            std::optional<std::pair<Encoded, std::uint64_t>> pending_;  // chunk and the input offset after it
+            bool closing_;
+            std::exception_ptr error_;
+            std::thread thread_;
+
+            void work()
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+
+                while (true)
+                {
+                    changed_.wait(lock, [this] {return closing_ || pending_;});
+
+                    if (!pending_) {return;}
+
+                    std::pair<Encoded, std::uint64_t> chunk = std::move(*pending_);
+
+                    lock.unlock();
+
+                    try
+                    {
+                        out_.write(chunk.first.data.data(), static_cast<std::streamsize>(chunk.first.data.size()));
+                        out_.flush();
+
+                        if (!out_) {throw std::runtime_error(CORPUS_IO);}
+
+                        sync(config_.outputPath);
+
+                        const CorpusStats& d = chunk.first.delta;
+
+                        stats_.chunks += d.chunks;
+                        stats_.states += d.states;
+                        stats_.solved += d.solved;
+                        stats_.partial += d.partial;
+                        stats_.invalid += d.invalid;
+                        stats_.duplicates += d.duplicates;
+                        stats_.inputOffset = chunk.second;
+                        stats_.outputLength += chunk.first.data.size();
+                        save(config_, stats_);
+                    }
+                    catch (...)
+                    {
+                        lock.lock();
+                        error_ = std::current_exception();
+                        pending_.reset();
+                        changed_.notify_all();
+
+                        return;
+                    }
+
+                    lock.lock();
+                    pending_.reset();
+                    changed_.notify_all();
+                }
+            }
+
+            void rethrow()
+            {
+                if (error_) {std::rethrow_exception(error_);}
+            }
+
+        public:
+            Writer(const CorpusConfig& config, CorpusStats& stats) :
+                config_(config),
+                stats_(stats),
+                out_(config.outputPath, std::ios::binary | std::ios::app),
+                closing_(false)
+            {
+                if (!out_) {throw std::runtime_error(CORPUS_IO);}
+
+                thread_ = std::thread([this] {work();});
+            }
+
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+
+            ~Writer()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+
+                    closing_ = true;
+                }
+
+                changed_.notify_all();
+                thread_.join();
+            }
+
+            // Waits for the previous chunk to be written, so at most one is in flight.
+            void push(Encoded chunk, std::uint64_t offset)
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+
+                changed_.wait(lock, [this] {return !pending_ || error_;});
+                rethrow();
+                pending_.emplace(std::move(chunk), offset);
+                changed_.notify_all();
+            }
+
+            void drain()
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+
+                changed_.wait(lock, [this] {return !pending_ || error_;});
+                rethrow();
+            }
+        };
+
+        CorpusStats solve(const CorpusConfig& config)
+        {
+            CorpusStats stats;
+
+            if (load(config, stats))
+            {
+                std::error_code ec;
+                std::uint64_t length = fs::file_size(config.outputPath, ec);
+
+                if (ec || length < stats.outputLength) {throw std::runtime_error(CORPUS_MANIFEST);}
+
+                // Drops whatever an interrupted write left past the last committed chunk.
+                fs::resize_file(config.outputPath, stats.outputLength);
+                stats.resumed = true;
+
+                if (stats.finished) {return stats;}
+            }
+            else
+            {
+                std::ofstream out(config.outputPath, std::ios::binary | std::ios::trunc);
+
+                if (!out) {throw std::runtime_error(CORPUS_IO);}
+
+                save(config, stats);
+            }
+
+            ChunkReader reader(config.inputPath, config.input, stats.inputOffset);
+            std::vector<PackedCube> states;
+            std::vector<bool> valid;
+            regi base = stats.states;
+            bool finished = false;
+            Memo memo;
+
+            {
+                Writer writer(config, stats);
+
+                while (!config.token.cancelled())
+                {
+                    std::uint64_t offset = reader.next(std::max<regi>(config.chunkSize, 1), states, valid);
+
+                    if (states.empty()) {finished = true; break;}
+
+                    Encoded chunk = solveChunk(config, base, states, valid, memo);
+
+                    // A cancelled chunk may hold unfinished solves; leave it to the next run.
+                    if (config.token.cancelled()) {break;}
+
+                    base += states.size();
+                    writer.push(std::move(chunk), offset);
+                }
+
+                writer.drain();
+            }
+
+            if (finished)
+            {
+                stats.finished = true;
+                save(config, stats);
+            }
+
+            return stats;
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Batch.hpp"
+#include "Daemon.hpp"
+#include <string>
+
+namespace slvr
+{
+    // Offline solving of large scramble files. Input is read in fixed-size chunks; each chunk is
+    // deduplicated, checked against the solutions of earlier chunks, solved with the batch
+    // scheduler on every core and handed to a writer thread, which appends the results to the
+    // output file while the next chunk is being solved. After a chunk is on disk the writer
+    // rewrites a manifest with the input offset to resume from, the committed output length and
+    // running totals. The output and the new manifest are synced
+    // before the manifest replaces the old one, so a commit survives power loss as well as a crash.
+    // A restarted job truncates the output to the committed length and carries on from the
+    // recorded offset, so an interruption costs the chunk being solved plus, at worst, the one
+    // whose write it cut short.
+    namespace corpus
+    {
+        enum class InputFormat : byte
+        {
+            TEXT,   // one scramble in move notation per line; lines with other tokens are invalid
+            PACKED  // packedCubeSize-byte records, as written by writePacked
+        };
+
+        // TEXT writes "<index> <status> <moves>" lines; BINARY writes the daemon's SOLVE reply
+        // records (u8 status, u8 length, length move bytes) in input order.
+        enum class OutputFormat : byte
+        {
+            TEXT,
+            BINARY
+        };
+
+        struct CorpusConfig
+        {
+            std::string inputPath;
+            std::string outputPath;
+            std::string manifestPath;  // empty uses outputPath + ".manifest"
+            InputFormat input   = InputFormat::TEXT;
+            OutputFormat output = OutputFormat::TEXT;
+            regi chunkSize = 4096;
+            regi threads   = std::thread::hardware_concurrency();
+            Clock::duration budget = Clock::duration::zero();  // per distinct cube, zero for none
+            thistlethwaite::SolveOptions options{false, false, true, 1};  // see batch::BatchConfig
+            regi memoLimit = regi(1) << 18;  // solved states remembered across chunks, not across restarts
+            CancellationToken token;   // stops after the chunk being solved has been written
+        };
+
+        struct CorpusStats
+        {
+            regi chunks     = 0;  // committed, including those from earlier runs
+            regi states     = 0;
+            regi solved     = 0;
+            regi partial    = 0;
+            regi invalid    = 0;
+            regi duplicates = 0;  // inputs answered from an earlier input instead of being solved
+            std::uint64_t inputOffset  = 0;
+            std::uint64_t outputLength = 0;
+            bool resumed  = false;
+            bool finished = false;  // reached the end of the input
+        };
+
+        [[nodiscard]] CorpusStats solve(const CorpusConfig& config);
+    }
+}
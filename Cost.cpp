@@ -0,0 +1,203 @@
+#include "Cost.hpp"
+
+namespace slvr
+{
+    namespace cost
+    {
+        // Move that a then b on the same face amount to, or noPrevious if they cancel.
+        static byte combine(byte a, byte b) noexcept
+        {
+            constexpr std::array<byte, 3> quarters {1, 3, 2};
+            constexpr std::array<byte, 4> variant {noPrevious, 0, 2, 1};
+
+            byte v = variant[(quarters[a % 3] + quarters[b % 3]) % 4];
+
+            return v == noPrevious ? noPrevious : static_cast<byte>(a / 3 * 3 + v);
+        }
+
+        // Checks the merge for every move before the pair (or none) and every move after it (or none).
+        static bool mergesSameFace(const std::array<std::array<Cost, 18>, 19>& table) noexcept
+        {
+            auto step = [&table](byte previous, byte move) -> Cost {return move == noPrevious ? 0 : table[previous][move];};
+
+            for (byte previous = 0; previous <= noPrevious; ++previous)
+            {
+                for (byte a = 0; a < 18; ++a)
+                {
+                    for (byte b = a / 3 * 3; b < a / 3 * 3 + 3; ++b)
+                    {
+                        byte merged = combine(a, b);
+
+                        for (byte after = 0; after <= noPrevious; ++after)
+                        {
+                            Cost pair = table[previous][a] + table[a][b] + step(b, after);
+                            Cost single = merged == noPrevious ? step(previous, after) : table[previous][merged] + step(merged, after);
+
+                            if (single > pair) {return false;}
+                        }
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        CostModel::CostModel(const std::array<std::array<Cost, 18>, 19>& table) noexcept :
+            table_(table),
+            cheapest_(unbounded),
+            contextFree_(true),
+            mergesSameFace_(cost::mergesSameFace(table))
+        {
+            for (const auto& row : table_)
+            {
+                for (Cost c : row) {cheapest_ = std::min(cheapest_, c);}
+
+                contextFree_ = contextFree_ && row == table_[0];
+            }
+        }
+
+        CostModel CostModel::htm() noexcept
+        {
+            std::array<std::array<Cost, 18>, 19> table;
+
+            for (auto& row : table) {row.fill(1);}
+
+            return CostModel(table);
+        }
+
+        CostModel CostModel::qtm() noexcept
+        {
+            return fromProfile(Profile{{{{1, 2}, {1, 2}, {1, 2}}}, 0, 0, 0});
+        }
+
+        CostModel CostModel::fromProfile(const Profile& profile) noexcept
+        {
+            std::array<std::array<Cost, 18>, 19> table;
+
+            for (byte previous = 0; previous <= noPrevious; ++previous)
+            {
+                for (byte move = 0; move < 18; ++move)
+                {
+                    byte axis = move / 6;
+                    const AxisTiming& timing = profile.axes[axis];
+                    Cost c = move % 3 == 2 ? timing.half : timing.quarter;
+
+                    if (previous != noPrevious)
+                    {
+                        byte previousAxis = previous / 6;
+
+                        if (previousAxis == axis)         {c += profile.sameAxis;}
+                        else
+                        {
+                            c += profile.axisChange;
+
+                            if (previous % 3 != 2) {c += profile.regrip;}
+                        }
+                    }
+
+                    table[previous][move] = c;
+                }
+            }
+
+            return CostModel(table);
+        }
+
+        Cost CostModel::cheapest() const noexcept {return cheapest_;}
+        bool CostModel::contextFree() const noexcept {return contextFree_;}
+        bool CostModel::mergesSameFace() const noexcept {return mergesSameFace_;}
+
+        Cost CostModel::evaluate(const std::vector<Move>& moves, byte previous) const noexcept
+        {
+            Cost total = 0;
+
+            for (Move move : moves)
+            {
+                total += (*this)(previous, move);
+                previous = static_cast<byte>(move);
+            }
+
+            return total;
+        }
+
+        CostResult optimal(const Cube& cube, const CostModel& model, const SearchLimits& limits, regi maxDepth)
+        {
+            CostResult result;
+            std::atomic<bool> solutionFound(false);
+            SearchContext ctx(solutionFound, limits);
+            auto solved = [](const CubieState& s) {return s.isSolved();};
+
+            result.solved = run<thistlethwaite::g0Moves>(CubieState(cube), unbounded, maxDepth, noPrevious, Face::NULL_FACE, Face::NULL_FACE,
+                                                         model, result.solution, result.cost, ctx, solved,
+                                                         pruning::heuristic(pruning::TableId::CORNERS, limits.deadline));
+            result.timedOut = ctx.interrupted();
+
+            return result;
+        }
+
+        template <thistlethwaite::State G>
+        static bool phase(CubieState& state, const CostModel& model, std::vector<Move>& solution, Cost& total, SearchContext& ctx)
+        {
+            using namespace thistlethwaite;
+
+            constexpr byte p = static_cast<byte>(G);
+
+            byte previous = solution.empty() ? noPrevious : static_cast<byte>(solution.back());
+            Face last = solution.empty() ? Face::NULL_FACE : toFace(solution.back());
+            Face secondLast = solution.size() < 2 ? Face::NULL_FACE : toFace(solution[solution.size() - 2]);
+
+            std::vector<Move> path;
+            Cost c = 0;
+
+            if (!run<validMoves<G>()>(state, unbounded, maxPhaseDepths[p], previous, last, secondLast, model, path, c, ctx,
+                                      NextGroup<G>(), pruning::heuristic(pruning::phaseTable(p), ctx.deadline())))
+            {
+                return false;
+            }
+
+            for (Move move : path)
+            {
+                search::apply(state, move);
+                solution.push_back(move);
+            }
+
+            total += c;
+
+            return true;
+        }
+
+        CostResult solve(const Cube& cube, const CostModel& model, const SearchLimits& limits)
+        {
+            using thistlethwaite::State;
+
+            CostResult result;
+            std::atomic<bool> solutionFound(false);
+            SearchContext ctx(solutionFound, limits);
+            CubieState state(cube);
+
+            while (!state.isSolved())
+            {
+                bool advanced = false;
+
+                switch (thistlethwaite::state(state))
+                {
+                    case State::G0: advanced = phase<State::G0>(state, model, result.solution, result.cost, ctx); break;
+                    case State::G1: advanced = phase<State::G1>(state, model, result.solution, result.cost, ctx); break;
+                    case State::G2: advanced = phase<State::G2>(state, model, result.solution, result.cost, ctx); break;
+                    case State::G3: advanced = phase<State::G3>(state, model, result.solution, result.cost, ctx); break;
+                    default: break;
+                }
+
+                if (!advanced)
+                {
+                    result.timedOut = ctx.interrupted();
+
+                    return result;
+                }
+            }
+
+            result.solved = true;
+
+            return result;
+        }
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "Solver.hpp"
+#include <limits>
+
+namespace slvr
+{
+    // Execution-cost models and cost-optimal search. A model gives the cost of each move given the
+    // move before it, so a solver can minimise time on a particular machine rather than move count.
+    namespace cost
+    {
+        using Cost = std::uint32_t;
+
+        constexpr const Cost unbounded = std::numeric_limits<Cost>::max() / 2;
+
+        // Row of the cost table used for the first move of a sequence.
+        constexpr const byte noPrevious = 18;
+
+        struct AxisTiming
+        {
+            Cost quarter = 1;
+            Cost half    = 2;
+        };
+
+        // Per-axis turn times (R/L, U/D, F/B) plus transition costs: sameAxis after a move on the
+        // same axis, axisChange after a move on another axis, and regrip on top of that when the
+        // other axis was left a quarter turn out of line.
+        struct Profile
+        {
+            std::array<AxisTiming, 3> axes{};
+            Cost sameAxis   = 0;
+            Cost axisChange = 0;
+            Cost regrip     = 0;
+        };
+
+        class CostModel
+        {
+        private:
+            std::array<std::array<Cost, 18>, 19> table_;
+            Cost cheapest_;
+            bool contextFree_;
+            bool mergesSameFace_;
+
+        public:
+            explicit CostModel(const std::array<std::array<Cost, 18>, 19>& table) noexcept;
+
+            [[nodiscard]] static CostModel htm() noexcept;
+            [[nodiscard]] static CostModel qtm() noexcept;
+            [[nodiscard]] static CostModel fromProfile(const Profile& profile) noexcept;
+
+            [[nodiscard]] Cost operator()(byte previous, Move move) const noexcept
+            {
+                return table_[previous][static_cast<byte>(move)];
+            }
+
+            // Smallest entry in the table: a lower bound on the cost of any single move.
+            [[nodiscard]] Cost cheapest() const noexcept;
+
+            // Every row is the same, so a move costs the same whatever came before it.
+            [[nodiscard]] bool contextFree() const noexcept;
+
+            // Two moves on one face never cost less than the single move they combine into (or
+            // nothing, if they cancel), counting the move before them and the one after.
+            [[nodiscard]] bool mergesSameFace() const noexcept;
+
+            [[nodiscard]] Cost evaluate(const std::vector<Move>& moves, byte previous = noPrevious) const noexcept;
+        };
+
+        struct CostResult
+        {
+            std::vector<Move> solution;
+            Cost cost     = 0;
+            bool solved   = false;
+            bool timedOut = false;
+        };
+
+        // Kernel policy for one iteration of run(): edges weighted by the model, goals reported while
+        // they fit under the threshold, and the cheapest f value cut off kept for the next one.
+        template <class Goal>
+        struct CostPolicy : search::CountPolicy<Goal>
+        {
+            const CostModel& model;
+            const Cost& threshold;
+            Cost& next;
+            Cost unit;
+            bool sameFace;
+            bool commuting;
+
+            [[nodiscard]] bool pruned(byte face, byte last, byte secondLast) const noexcept
+            {
+                return commuting ? search::redundant(face, last, secondLast) : sameFace && face == last;
+            }
+
+            [[nodiscard]] Cost step(byte previous, Move move) const noexcept {return model(previous, move);}
+
+            [[nodiscard]] search::Visit visit(const CubieState& child, regi, Cost g) const
+            {
+                if (!this->goal(child)) {return search::Visit::EXPAND;}
+                if (g <= threshold) {return search::Visit::REPORT;}
+
+                next = std::min(next, g);
+
+                return search::Visit::CUT;
+            }
+
+            [[nodiscard]] bool admit(regi, Cost g, byte d) const noexcept
+            {
+                Cost f = g + std::max<Cost>(d, 1) * unit;
+
+                if (f > threshold) {next = std::min(next, f); return false;}
+
+                return true;
+            }
+        };
+
+        // Cost-bounded IDA* with at most maxDepth moves. Edges are weighted by the model and the
+        // heuristic's move-count bound is scaled by the cheapest move, which keeps it consistent.
+        // With many distinct costs, stepping the threshold to the next f value alone would mean
+        // one iteration per value, so it grows by at least the cheapest move and an iteration that
+        // finds a solution finishes as branch and bound below it. previous is the move before
+        // start (noPrevious if none). On success path and pathCost hold the cheapest sequence.
+        // Consecutive moves on one face are only pruned when the model's mergesSameFace() holds,
+        // and commuting opposite faces only when it is also context-free: otherwise the order of
+        // the moves changes the cost, and redundant() could cut off the cheapest sequence.
+        template <const auto& Moves, class Goal, class Heuristic = search::NoHeuristic>
+        bool run(const CubieState& start, Cost maxCost, regi maxDepth, byte previous, Face last, Face secondLast,
+                 const CostModel& model, std::vector<Move>& path, Cost& pathCost, SearchContext& ctx,
+                 const Goal& goal, const Heuristic& heuristic = {})
+        {
+            path.clear();
+            pathCost = 0;
+
+            if (goal(start)) {return true;}
+            if (maxDepth > search::maxSearchDepth) {maxDepth = search::maxSearchDepth;}
+
+            const Cost unit = std::max<Cost>(model.cheapest(), 1);
+            const bool sameFace = model.mergesSameFace();
+            byte d = heuristic.initial(start);
+
+            if (maxDepth == 0 || d > maxDepth) {return false;}
+
+            bool found = false;
+
+            for (Cost threshold = std::max<Cost>(d, 1) * unit; threshold <= maxCost && !found;)
+            {
+                Cost next = unbounded;
+                CostPolicy<Goal> policy{{goal}, model, threshold, next, unit, sameFace, sameFace && model.contextFree()};
+                search::Kernel<Moves, CostPolicy<Goal>, Heuristic> kernel(start, d, last, secondLast, maxDepth, policy, heuristic, ctx, previous);
+
+                while (true)
+                {
+                    search::Event event = kernel.next();
+
+                    if (event == search::Event::STOPPED) {return false;}
+                    if (event == search::Event::EXHAUSTED) {break;}
+
+                    // Siblings were reported against the threshold at the time they were generated.
+                    if (kernel.cost() > threshold) {continue;}
+
+                    path.assign(kernel.moves().begin(), kernel.moves().begin() + kernel.length());
+                    pathCost = kernel.cost();
+                    threshold = kernel.cost() - 1;
+                    found = true;
+                }
+
+                threshold = std::max(next, threshold + unit);
+            }
+
+            return found;
+        }
+
+        // Cheapest solution under model, using the corner table as heuristic.
+        [[nodiscard]] CostResult optimal(const Cube& cube, const CostModel& model, const SearchLimits& limits = {}, regi maxDepth = 20);
+
+        // Thistlethwaite phases, each the cheapest way into the next group given the move before it.
+        [[nodiscard]] CostResult solve(const Cube& cube, const CostModel& model, const SearchLimits& limits = {});
+    }
+}
@@ -149,7 +149,7 @@ namespace slvr
 
 	void Cube::checkPermutationParity(const corner_arr& corners, const edge_arr& edges)
 	{
-		if (!(checkParity(corners) ^ checkParity(edges))) {throw std::invalid_argument(PERMUTATION);}
+		if (checkParity(corners) ^ checkParity(edges)) {throw std::invalid_argument(PERMUTATION);}
 	}
 
 	void Cube::checkCube(const corner_arr& cornerP, const corner_arr& cornerO, const edge_arr& edgeP, const edge_arr& edgeO)
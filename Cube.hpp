@@ -4,7 +4,8 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
-#include <array>
+#include <array>
+#include <climits>
 
 using byte = unsigned char;
 using regi = std::size_t;
@@ -0,0 +1,472 @@
+#include "Daemon.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SOCKET_OPEN "Could not open solver socket"
+#define SOCKET_PATH "Solver socket path too long"
+#define SOCKET_IO "Solver socket closed unexpectedly"
+#define FRAME_COUNT "Too many cubes in one request"
+
+namespace slvr
+{
+    static bool readAll(int fd, void* data, regi n) noexcept
+    {
+        byte* p = static_cast<byte*>(data);
+
+        while (n > 0)
+        {
+            ssize_t got = ::recv(fd, p, n, 0);
+
+            if (got <= 0) {return false;}
+
+            p += got;
+            n -= static_cast<regi>(got);
+        }
+
+        return true;
+    }
+
+    static bool writeAll(int fd, const void* data, regi n) noexcept
+    {
+        const byte* p = static_cast<const byte*>(data);
+
+        while (n > 0)
+        {
+            ssize_t sent = ::send(fd, p, n, MSG_NOSIGNAL);
+
+            if (sent <= 0) {return false;}
+
+            p += sent;
+            n -= static_cast<regi>(sent);
+        }
+
+        return true;
+    }
+
+    static sockaddr_un socketAddress(const std::string& path)
+    {
+        sockaddr_un addr{};
+
+        if (path.size() >= sizeof(addr.sun_path)) {throw std::invalid_argument(SOCKET_PATH);}
+
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        return addr;
+    }
+
+    SolveDaemon::SolveDaemon(DaemonConfig config) :
+        config_(std::move(config)),
+        executor_(config_.threads),
+        started_(Clock::now()),
+        listenFd_(-1),
+        stopping_(false)
+    {
+        dispatcher_ = std::thread([this] {dispatch();});
+    }
+
+    SolveDaemon::~SolveDaemon()
+    {
+        stop();
+
+        if (dispatcher_.joinable()) {dispatcher_.join();}
+
+        // Completion callbacks use mtx_ and stats_, which are destroyed before executor_.
+        executor_.shutdown();
+        reap(true);
+    }
+
+    std::future<DaemonReply> SolveDaemon::enqueue(const PackedCube& state, Priority priority, Deadline deadline)
+    {
+        auto pending = std::make_unique<Pending>(Pending{state, priority, deadline, {}});
+        std::future<DaemonReply> reply = pending->reply.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            ++stats_.states;
+
+            // The dispatcher may already have drained and exited; nothing would answer this one.
+            if (stopping_)
+            {
+                ++stats_.partial;
+                pending->reply.set_value(DaemonReply{protocol::Status::PARTIAL, {}});
+
+                return reply;
+            }
+
+            incoming_.push_back(std::move(pending));
+        }
+
+        arrived_.notify_one();
+
+        return reply;
+    }
+
+    void SolveDaemon::dispatch()
+    {
+        using Group = std::vector<std::unique_ptr<Pending>>;
+
+        while (true)
+        {
+            Group batch;
+
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+
+                arrived_.wait(lock, [this] {return stopping_ || !incoming_.empty();});
+
+                if (incoming_.empty()) {return;}
+
+                arrived_.wait_until(lock, Clock::now() + config_.batchWindow, [this]
+                {
+                    return stopping_ || incoming_.size() >= config_.maxBatch;
+                });
+
+                batch.swap(incoming_);
+
+                ++stats_.batches;
+            }
+
+            std::sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) {return a->state < b->state;});
+
+            for (regi i = 0; i < batch.size();)
+            {
+                auto group = std::make_shared<Group>();
+                Priority priority = batch[i]->priority;
+                Deadline deadline = batch[i]->deadline;
+
+                for (; i < batch.size() && (group->empty() || batch[i]->state == group->front()->state); ++i)
+                {
+                    priority = std::max(priority, batch[i]->priority);
+                    deadline = std::min(deadline, batch[i]->deadline, [](const Deadline& a, const Deadline& b) {return a.time() < b.time();});
+
+                    group->push_back(std::move(batch[i]));
+                }
+
+                std::optional<Cube> cube;
+
+                try
+                {
+                    cube = unpack(group->front()->state);
+                }
+                catch (const std::invalid_argument&)
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+
+                    stats_.invalid += group->size();
+
+                    for (auto& p : *group) {p->reply.set_value(DaemonReply{protocol::Status::INVALID, {}});}
+
+                    continue;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+
+                    stats_.coalesced += group->size() - 1;
+                }
+
+                SearchLimits limits;
+                limits.deadline = deadline;
+
+                // A solve that threw leaves result empty and unsolved, so it is answered as PARTIAL.
+                executor_.submit(*cube, [this, group](const SolveExecutor::Result& result, std::exception_ptr)
+                {
+                    protocol::Status status = result.solved ? protocol::Status::SOLVED : protocol::Status::PARTIAL;
+
+                    {
+                        std::lock_guard<std::mutex> lock(mtx_);
+
+                        (result.solved ? stats_.solved : stats_.partial) += group->size();
+                    }
+
+                    for (auto& p : *group) {p->reply.set_value(DaemonReply{status, result.solution});}
+                }, priority, limits);
+            }
+        }
+    }
+
+    void SolveDaemon::solveFrame(int fd, const byte* header)
+    {
+        Priority priority = static_cast<Priority>(std::min<byte>(header[1], static_cast<byte>(Priority::INTERACTIVE)));
+        regi count = header[2] | (header[3] << 8);
+        std::uint32_t budget = 0;
+
+        for (regi i = 0; i < 4; ++i) {budget |= static_cast<std::uint32_t>(header[4 + i]) << (8 * i);}
+
+        if (count > protocol::maxCount) {throw std::invalid_argument(FRAME_COUNT);}
+
+        std::vector<byte> body(count * packedCubeSize);
+
+        if (!readAll(fd, body.data(), body.size())) {throw std::runtime_error(SOCKET_IO);}
+
+        Deadline deadline = Deadline::after(budget ? std::chrono::microseconds(budget) : config_.defaultBudget);
+        std::vector<std::future<DaemonReply>> replies;
+
+        replies.reserve(count);
+
+        for (regi i = 0; i < count; ++i)
+        {
+            replies.push_back(enqueue(readPacked(body.data() + i * packedCubeSize), priority, deadline));
+        }
+
+        std::vector<byte> out;
+
+        for (auto& f : replies)
+        {
+            DaemonReply reply = f.get();
+
+            out.push_back(static_cast<byte>(reply.status));
+            out.push_back(static_cast<byte>(reply.solution.size()));
+
+            for (Move move : reply.solution) {out.push_back(static_cast<byte>(move));}
+        }
+
+        if (!writeAll(fd, out.data(), out.size())) {throw std::runtime_error(SOCKET_IO);}
+    }
+
+    void SolveDaemon::statsFrame(int fd)
+    {
+        std::string json = statsJson();
+        byte length[4];
+
+        for (regi i = 0; i < 4; ++i) {length[i] = static_cast<byte>(json.size() >> (8 * i));}
+
+        if (!writeAll(fd, length, 4) || !writeAll(fd, json.data(), json.size())) {throw std::runtime_error(SOCKET_IO);}
+    }
+
+    void SolveDaemon::serve(Client& client)
+    {
+        byte header[protocol::headerSize];
+
+        try
+        {
+            while (!stopping_ && readAll(client.fd, header, protocol::headerSize))
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+
+                    ++stats_.requests;
+                }
+
+                switch (static_cast<protocol::Opcode>(header[0]))
+                {
+                    case protocol::Opcode::SOLVE: solveFrame(client.fd, header); break;
+                    case protocol::Opcode::STATS: statsFrame(client.fd);         break;
+
+                    default: throw std::invalid_argument("Unknown opcode");
+                }
+            }
+        }
+        catch (const std::exception&) {}
+
+        ::close(client.fd);
+
+        client.done = true;
+    }
+
+    void SolveDaemon::reap(bool all)
+    {
+        for (auto it = clients_.begin(); it != clients_.end();)
+        {
+            if (all || it->done)
+            {
+                if (all && !it->done) {::shutdown(it->fd, SHUT_RDWR);}
+
+                it->thread.join();
+                it = clients_.erase(it);
+            }
+            else {++it;}
+        }
+    }
+
+    void SolveDaemon::run()
+    {
+        sockaddr_un addr = socketAddress(config_.socketPath);
+
+        int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (listenFd < 0) {throw std::runtime_error(SOCKET_OPEN);}
+
+        ::unlink(config_.socketPath.c_str());
+
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listenFd, SOMAXCONN) < 0)
+        {
+            ::close(listenFd);
+
+            throw std::runtime_error(SOCKET_OPEN);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            listenFd_ = listenFd;
+        }
+
+        while (!stopping_)
+        {
+            int fd = ::accept(listenFd, nullptr, nullptr);
+
+            if (fd < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED || stopping_) {continue;}
+
+                // Out of descriptors or memory: free what finished clients hold and wait rather than spin.
+                reap(false);
+
+                std::unique_lock<std::mutex> lock(mtx_);
+
+                stopped_.wait_for(lock, config_.acceptBackoff, [this] {return stopping_.load();});
+
+                continue;
+            }
+
+            reap(false);
+
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+
+                ++stats_.connections;
+            }
+
+            Client& client = clients_.emplace_back();
+
+            client.fd = fd;
+            client.done = false;
+            client.thread = std::thread([this, &client] {serve(client);});
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            ::close(listenFd);
+            listenFd_ = -1;
+        }
+
+        ::unlink(config_.socketPath.c_str());
+        reap(true);
+    }
+
+    void SolveDaemon::stop()
+    {
+        {
+            // Under the lock, so enqueue() and the dispatcher see the flag in a consistent order.
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            if (stopping_.exchange(true)) {return;}
+            if (listenFd_ >= 0) {::shutdown(listenFd_, SHUT_RDWR);}
+        }
+
+        arrived_.notify_all();
+        stopped_.notify_all();
+    }
+
+    DaemonStats SolveDaemon::stats()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        return stats_;
+    }
+
+    std::string SolveDaemon::statsJson()
+    {
+        DaemonStats s = stats();
+        auto uptime = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started_).count();
+        std::ostringstream os;
+
+        os << "{\"uptime_ms\":"   << uptime
+           << ",\"threads\":"     << executor_.threads()
+           << ",\"queued\":"      << executor_.pending()
+           << ",\"connections\":" << s.connections
+           << ",\"requests\":"    << s.requests
+           << ",\"states\":"      << s.states
+           << ",\"batches\":"     << s.batches
+           << ",\"mean_batch\":"  << (s.batches ? static_cast<double>(s.states) / s.batches : 0.0)
+           << ",\"coalesced\":"   << s.coalesced
+           << ",\"solved\":"      << s.solved
+           << ",\"partial\":"     << s.partial
+           << ",\"invalid\":"     << s.invalid
+           << '}';
+
+        return os.str();
+    }
+
+    DaemonClient::DaemonClient(const std::string& socketPath) :
+        fd_(::socket(AF_UNIX, SOCK_STREAM, 0))
+    {
+        if (fd_ < 0) {throw std::runtime_error(SOCKET_OPEN);}
+
+        sockaddr_un addr = socketAddress(socketPath);
+
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            ::close(fd_);
+
+            throw std::runtime_error(SOCKET_OPEN);
+        }
+    }
+
+    DaemonClient::~DaemonClient() {::close(fd_);}
+
+    std::vector<DaemonReply> DaemonClient::solve(const std::vector<Cube>& cubes, Priority priority, std::chrono::microseconds budget)
+    {
+        if (cubes.size() > protocol::maxCount) {throw std::invalid_argument(FRAME_COUNT);}
+
+        std::vector<byte> frame(protocol::headerSize + cubes.size() * packedCubeSize);
+        std::uint32_t micros = static_cast<std::uint32_t>(budget.count());
+
+        frame[0] = static_cast<byte>(protocol::Opcode::SOLVE);
+        frame[1] = static_cast<byte>(priority);
+        frame[2] = static_cast<byte>(cubes.size());
+        frame[3] = static_cast<byte>(cubes.size() >> 8);
+
+        for (regi i = 0; i < 4; ++i) {frame[4 + i] = static_cast<byte>(micros >> (8 * i));}
+
+        for (regi i = 0; i < cubes.size(); ++i)
+        {
+            writePacked(pack(cubes[i]), frame.data() + protocol::headerSize + i * packedCubeSize);
+        }
+
+        if (!writeAll(fd_, frame.data(), frame.size())) {throw std::runtime_error(SOCKET_IO);}
+
+        std::vector<DaemonReply> replies(cubes.size());
+
+        for (auto& reply : replies)
+        {
+            byte head[2];
+
+            if (!readAll(fd_, head, 2)) {throw std::runtime_error(SOCKET_IO);}
+
+            std::vector<byte> moves(head[1]);
+
+            if (!moves.empty() && !readAll(fd_, moves.data(), moves.size())) {throw std::runtime_error(SOCKET_IO);}
+
+            reply.status = static_cast<protocol::Status>(head[0]);
+
+            for (byte m : moves) {reply.solution.push_back(static_cast<Move>(m));}
+        }
+
+        return replies;
+    }
+
+    std::string DaemonClient::stats()
+    {
+        byte frame[protocol::headerSize] = {static_cast<byte>(protocol::Opcode::STATS)};
+        byte length[4];
+
+        if (!writeAll(fd_, frame, sizeof(frame)) || !readAll(fd_, length, 4)) {throw std::runtime_error(SOCKET_IO);}
+
+        std::uint32_t n = length[0] | (length[1] << 8) | (length[2] << 16) | (static_cast<std::uint32_t>(length[3]) << 24);
+        std::string json(n, '\0');
+
+        if (n && !readAll(fd_, json.data(), n)) {throw std::runtime_error(SOCKET_IO);}
+
+        return json;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Executor.hpp"
+#include "Packed.hpp"
+#include <chrono>
+#include <list>
+
+namespace slvr
+{
+    // Wire format, little endian. A request is an 8 byte header followed by count packed cubes:
+    //   u8 opcode, u8 priority, u16 count, u32 budget in microseconds (0 uses the daemon default)
+    // A SOLVE reply holds one record per cube: u8 status, u8 length, length move bytes.
+    // A STATS reply is a u32 length followed by a JSON object.
+    namespace protocol
+    {
+        enum class Opcode : byte
+        {
+            SOLVE = 1,
+            STATS = 2
+        };
+
+        enum class Status : byte
+        {
+            SOLVED   = 0,
+            PARTIAL  = 1,
+            INVALID  = 2
+        };
+
+        constexpr const regi headerSize = 8;
+        constexpr const regi maxCount   = 4096;
+    }
+
+    struct DaemonReply
+    {
+        protocol::Status status;
+        std::vector<Move> solution;
+    };
+
+    struct DaemonConfig
+    {
+        std::string socketPath = "/tmp/slvr.sock";
+        regi threads = std::thread::hardware_concurrency();
+        regi maxBatch = 256;
+        std::chrono::microseconds batchWindow{500};
+        std::chrono::microseconds defaultBudget{50000};
+        std::chrono::milliseconds acceptBackoff{100};  // pause after accept() fails for lack of resources
+    };
+
+    struct DaemonStats
+    {
+        regi connections = 0;
+        regi requests    = 0;
+        regi states      = 0;
+        regi batches     = 0;
+        regi coalesced   = 0;
+        regi solved      = 0;
+        regi partial     = 0;
+        regi invalid     = 0;
+    };
+
+    class SolveDaemon
+    {
+    private:
+        struct Pending
+        {
+            PackedCube state;
+            Priority priority;
+            Deadline deadline;
+            std::promise<DaemonReply> reply;
+        };
+
+        struct Client
+        {
+            int fd;
+            std::thread thread;
+            std::atomic<bool> done;
+        };
+
+        DaemonConfig config_;
+        SolveExecutor executor_;
+        std::vector<std::unique_ptr<Pending>> incoming_;
+        std::mutex mtx_;
+        std::condition_variable arrived_;
+        std::condition_variable stopped_;  // wakes run() from an accept backoff
+        std::thread dispatcher_;
+        std::list<Client> clients_;
+        DaemonStats stats_;
+        Clock::time_point started_;
+        int listenFd_;  // guarded by mtx_, so stop() never shuts down a closed and reused fd
+        std::atomic<bool> stopping_;
+
+        void dispatch();
+        void serve(Client& client);
+        void reap(bool all);
+        void solveFrame(int fd, const byte* header);
+        void statsFrame(int fd);
+        [[nodiscard]] std::future<DaemonReply> enqueue(const PackedCube& state, Priority priority, Deadline deadline);
+
+    public:
+        explicit SolveDaemon(DaemonConfig config = {});
+        SolveDaemon(const SolveDaemon&) = delete;
+        SolveDaemon& operator=(const SolveDaemon&) = delete;
+        ~SolveDaemon();
+
+        void run();
+        void stop();
+
+        [[nodiscard]] DaemonStats stats();
+        [[nodiscard]] std::string statsJson();
+    };
+
+    class DaemonClient
+    {
+    private:
+        int fd_;
+
+    public:
+        explicit DaemonClient(const std::string& socketPath);
+        DaemonClient(const DaemonClient&) = delete;
+        DaemonClient& operator=(const DaemonClient&) = delete;
+        ~DaemonClient();
+
+        [[nodiscard]] std::vector<DaemonReply> solve(const std::vector<Cube>& cubes, Priority priority = Priority::INTERACTIVE,
+                                                           std::chrono::microseconds budget = std::chrono::microseconds::zero());
+        [[nodiscard]] std::string stats();
+    };
+}
@@ -0,0 +1,137 @@
+#include "Executor.hpp"
+#include "Simplify.hpp"
+#include <algorithm>
+
+namespace slvr
+{
+    SolveExecutor::SolveExecutor(regi threads) :
+        sequence_(0),
+        running_(0),
+        stopping_(false)
+    {
+        if (threads == 0) {threads = 1;}
+
+        // Jobs usually carry a deadline, under which solve() won't build the tables itself.
+        pruning::prepare();
+        simplify::prepare();
+
+        workers_.reserve(threads);
+
+        for (regi i = 0; i < threads; ++i)
+        {
+            workers_.emplace_back([this] {work();});
+        }
+    }
+
+    SolveExecutor::~SolveExecutor() {shutdown();}
+
+    void SolveExecutor::push(Priority priority, std::function<void()> run)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            if (stopping_) {throw std::logic_error("Executor is shut down");}
+
+            queue_.push_back(Job{priority, sequence_++, std::move(run)});
+            std::push_heap(queue_.begin(), queue_.end(), JobOrder());
+        }
+
+        available_.notify_one();
+    }
+
+    void SolveExecutor::work()
+    {
+        while (true)
+        {
+            Job job;
+
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+
+                available_.wait(lock, [this] {return stopping_ || !queue_.empty();});
+
+                if (queue_.empty()) {return;}
+
+                std::pop_heap(queue_.begin(), queue_.end(), JobOrder());
+                job = std::move(queue_.back());
+                queue_.pop_back();
+                ++running_;
+            }
+
+            job.run();
+
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            --running_;
+        }
+    }
+
+    std::future<SolveExecutor::Result> SolveExecutor::submit(const Cube& cube, Priority priority,
+                                                             const SearchLimits& limits, Options options)
+    {
+        options.parallel = false;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>([cube, limits, options]
+        {
+            return thistlethwaite::solve(cube, limits, options);
+        });
+
+        std::future<Result> result = task->get_future();
+
+        push(priority, [task] {(*task)();});
+
+        return result;
+    }
+
+    void SolveExecutor::submit(const Cube& cube, Callback onComplete, Priority priority,
+                               const SearchLimits& limits, Options options)
+    {
+        options.parallel = false;
+
+        push(priority, [cube, limits, options, onComplete = std::move(onComplete)]
+        {
+            Result result;
+            std::exception_ptr error;
+
+            try {result = thistlethwaite::solve(cube, limits, options);}
+            catch (...) {error = std::current_exception();}
+
+            try {onComplete(result, error);}
+            catch (...) {}
+        });
+    }
+
+    regi SolveExecutor::threads() const noexcept {return workers_.size();}
+
+    regi SolveExecutor::pending() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        return queue_.size();
+    }
+
+    regi SolveExecutor::running() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        return running_;
+    }
+
+    void SolveExecutor::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            stopping_ = true;
+        }
+
+        available_.notify_all();
+
+        // Concurrent callers, such as an explicit shutdown() racing the destructor, wait here
+        // until the one joining the workers is done.
+        std::call_once(joined_, [this]
+        {
+            for (auto& t : workers_) {t.join();}
+        });
+    }
+}
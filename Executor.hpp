@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Solver.hpp"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+
+namespace slvr
+{
+    enum class Priority : byte
+    {
+        BATCH,
+        NORMAL,
+        INTERACTIVE
+    };
+
+    class SolveExecutor
+    {
+    public:
+        using Result   = thistlethwaite::SolveResult;
+        using Options  = thistlethwaite::SolveOptions;
+        // error is null on success; otherwise the solve threw and result is empty.
+        using Callback = std::function<void(const Result& result, std::exception_ptr error)>;
+
+    private:
+        struct Job
+        {
+            Priority priority;
+            regi sequence;
+            std::function<void()> run;
+        };
+
+        struct JobOrder
+        {
+            bool operator()(const Job& a, const Job& b) const noexcept
+            {
+                if (a.priority != b.priority) {return a.priority < b.priority;}
+
+                return a.sequence > b.sequence;
+            }
+        };
+
+        std::vector<Job> queue_;  // heap under JobOrder
+        mutable std::mutex mtx_;
+        std::condition_variable available_;
+        std::vector<std::thread> workers_;
+        regi sequence_;
+        regi running_;
+        bool stopping_;
+        std::once_flag joined_;
+
+        void push(Priority priority, std::function<void()> run);
+        void work();
+
+    public:
+        // Builds the pruning and simplify tables before starting the workers.
+        explicit SolveExecutor(regi threads = std::thread::hardware_concurrency());
+        SolveExecutor(const SolveExecutor&) = delete;
+        SolveExecutor& operator=(const SolveExecutor&) = delete;
+        ~SolveExecutor();
+
+        [[nodiscard]] std::future<Result> submit(const Cube& cube, Priority priority = Priority::NORMAL,
+                                                 const SearchLimits& limits = {}, Options options = {});
+
+        // onComplete runs on a worker thread. Anything it throws is dropped so the worker survives.
+        void submit(const Cube& cube, Callback onComplete, Priority priority = Priority::NORMAL,
+                    const SearchLimits& limits = {}, Options options = {});
+
+        [[nodiscard]] regi threads() const noexcept;
+        [[nodiscard]] regi pending() const;
+        [[nodiscard]] regi running() const;
+
+        void shutdown();
+    };
+}
@@ -0,0 +1,559 @@
+#include "ExternalBfs.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define BFS_IO "External BFS file error"
+#define BFS_TEMP "External BFS temp space limit exceeded"
+#define BFS_ENCODING "External BFS supports NIBBLE and MOD3 tables only"
+#define BFS_MANIFEST "External BFS manifest does not match the output table"
+#define TABLE_FORMAT "Not a solver table file"
+
+namespace slvr
+{
+    namespace external
+    {
+        namespace fs = std::filesystem;
+
+        static constexpr regi ioEntries = regi(1) << 16;
+        static constexpr regi blockBytes = regi(1) << 20;
+
+        class Reader
+        {
+        private:
+            std::ifstream in_;
+            std::vector<std::uint64_t> buf_;
+            regi pos_;
+            regi len_;
+
+        public:
+            explicit Reader(const fs::path& path) :
+                in_(path, std::ios::binary),
+                buf_(ioEntries),
+                pos_(0),
+                len_(0)
+            {
+                if (!in_) {throw std::runtime_error(BFS_IO);}
+            }
+
+            bool next(std::uint64_t& v)
+            {
+                if (pos_ == len_)
+                {
+                    in_.read(reinterpret_cast<char*>(buf_.data()), buf_.size() * sizeof(std::uint64_t));
+                    len_ = static_cast<regi>(in_.gcount()) / sizeof(std::uint64_t);
+                    pos_ = 0;
+
+                    if (len_ == 0) {return false;}
+                }
+
+                v = buf_[pos_++];
+
+                return true;
+            }
+        };
+
+        class Writer
+        {
+        private:
+            std::ofstream out_;
+            std::vector<std::uint64_t> buf_;
+            std::uint64_t count_;
+
+        public:
+            explicit Writer(const fs::path& path) :
+                out_(path, std::ios::binary | std::ios::trunc),
+                count_(0)
+            {
+                if (!out_) {throw std::runtime_error(BFS_IO);}
+
+                buf_.reserve(ioEntries);
+            }
+
+            void push(std::uint64_t v)
+            {
+                buf_.push_back(v);
+                ++count_;
+
+                if (buf_.size() == ioEntries) {flush();}
+            }
+
+            void flush()
+            {
+                out_.write(reinterpret_cast<const char*>(buf_.data()), buf_.size() * sizeof(std::uint64_t));
+                buf_.clear();
+
+                if (!out_) {throw std::runtime_error(BFS_IO);}
+            }
+
+            std::uint64_t close()
+            {
+                flush();
+                out_.close();
+
+                return count_;
+            }
+        };
+
+        struct Manifest
+        {
+            byte depth = 0;
+            bool merged = false;
+            std::vector<std::uint64_t> perDepth;
+        };
+
+        static fs::path frontierPath(const fs::path& dir, regi depth) {return dir / ("frontier-" + std::to_string(depth) + ".bin");}
+        static fs::path runPath(const fs::path& dir, regi depth, regi run) {return dir / ("run-" + std::to_string(depth) + '-' + std::to_string(run) + ".bin");}
+
+        static void save(const fs::path& dir, const Manifest& m)
+        {
+            fs::path tmp = dir / "manifest.tmp";
+
+            {
+                std::ofstream out(tmp, std::ios::trunc);
+
+                out << "depth " << static_cast<int>(m.depth) << "\nmerged " << m.merged << "\ncounts";
+
+                for (std::uint64_t c : m.perDepth) {out << ' ' << c;}
+
+                out << '\n';
+
+                if (!out) {throw std::runtime_error(BFS_IO);}
+            }
+
+            fs::rename(tmp, dir / "manifest");
+        }
+
+        static bool load(const fs::path& dir, Manifest& m)
+        {
+            std::ifstream in(dir / "manifest");
+
+            if (!in) {return false;}
+
+            std::string key, counts;
+            int depth = 0;
+
+            in >> key >> depth >> key >> m.merged >> key;
+            std::getline(in, counts);
+
+            std::istringstream is(counts);
+            std::uint64_t c;
+
+            while (is >> c) {m.perDepth.push_back(c);}
+
+            m.depth = static_cast<byte>(depth);
+
+            return !m.perDepth.empty();
+        }
+
+        static void checkTemp(const fs::path& dir, regi limit)
+        {
+            regi used = 0;
+
+            for (const auto& entry : fs::directory_iterator(dir))
+            {
+                if (entry.is_regular_file()) {used += entry.file_size();}
+            }
+
+            if (used > limit) {throw std::runtime_error(BFS_TEMP);}
+        }
+
+        static void createTable(const BfsConfig& config, std::uint64_t size)
+        {
+            std::ofstream out(config.outputPath, std::ios::binary | std::ios::trunc);
+            byte header[tableHeaderSize] = {};
+
+            std::memcpy(header, tableMagic, sizeof(tableMagic));
+            header[8] = static_cast<byte>(config.encoding);
+
+            for (regi i = 0; i < 8; ++i) {header[16 + i] = static_cast<byte>(size >> (8 * i));}
+
+            out.write(reinterpret_cast<const char*>(header), tableHeaderSize);
+
+            regi perByte = config.encoding == pruning::Encoding::NIBBLE ? 2 : 4;
+            regi remaining = static_cast<regi>((size + perByte - 1) / perByte);
+            std::vector<char> block(std::min(remaining, blockBytes), static_cast<char>(0xFF));
+
+            while (remaining > 0)
+            {
+                regi n = std::min(remaining, block.size());
+
+                out.write(block.data(), n);
+                remaining -= n;
+            }
+
+            if (!out) {throw std::runtime_error(BFS_IO);}
+        }
+
+        // Streams a sorted frontier into the table file, rewriting only the blocks it touches.
+        static void apply(const BfsConfig& config, const fs::path& frontier, byte depth)
+        {
+            std::fstream table(config.outputPath, std::ios::binary | std::ios::in | std::ios::out);
+
+            if (!table) {throw std::runtime_error(BFS_IO);}
+
+            bool nibble = config.encoding == pruning::Encoding::NIBBLE;
+            byte value = nibble ? std::min<byte>(depth, 14) : depth % 3;
+            std::vector<byte> block(blockBytes);
+            std::uint64_t current = UINT64_MAX;
+            regi length = 0;
+
+            auto flush = [&]
+            {
+                if (current == UINT64_MAX) {return;}
+
+                table.seekp(static_cast<std::streamoff>(tableHeaderSize + current * blockBytes));
+                table.write(reinterpret_cast<const char*>(block.data()), length);
+            };
+
+            Reader reader(frontier);
+            std::uint64_t index;
+
+            while (reader.next(index))
+            {
+                std::uint64_t byteIndex = nibble ? index >> 1 : index >> 2;
+                std::uint64_t b = byteIndex / blockBytes;
+
+                if (b != current)
+                {
+                    flush();
+
+                    current = b;
+                    table.seekg(static_cast<std::streamoff>(tableHeaderSize + b * blockBytes));
+                    table.read(reinterpret_cast<char*>(block.data()), blockBytes);
+                    length = static_cast<regi>(table.gcount());
+                    table.clear();
+                }
+
+                byte& cell = block[byteIndex % blockBytes];
+                regi shift = nibble ? (index & 1) * 4 : (index & 3) * 2;
+                byte mask = static_cast<byte>((nibble ? 15 : 3) << shift);
+
+                cell = static_cast<byte>((cell & ~mask) | (value << shift));
+            }
+
+            flush();
+
+            if (!table) {throw std::runtime_error(BFS_IO);}
+        }
+
+        static regi writeRun(std::vector<std::uint64_t>& buffer, const fs::path& path)
+        {
+            std::sort(buffer.begin(), buffer.end());
+            buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+
+            Writer out(path);
+
+            for (std::uint64_t v : buffer) {out.push(v);}
+
+            out.close();
+            buffer.clear();
+
+            return 1;
+        }
+
+        static std::uint64_t expand(const Space& space, const BfsConfig& config, const fs::path& dir, byte depth)
+        {
+            regi capacity = std::max<regi>(ioEntries, config.ramLimit / sizeof(std::uint64_t) / 2);
+            std::vector<std::uint64_t> buffer, next;
+            regi runs = 0;
+
+            for (const auto& entry : fs::directory_iterator(dir))
+            {
+                if (entry.path().filename().string().rfind("run-", 0) == 0) {fs::remove(entry.path());}
+            }
+
+            buffer.reserve(capacity);
+
+            {
+                Reader frontier(frontierPath(dir, depth));
+                std::uint64_t index;
+
+                while (frontier.next(index))
+                {
+                    space.successors(index, next);
+
+                    buffer.insert(buffer.end(), next.begin(), next.end());
+                    next.clear();
+
+                    if (buffer.size() + 64 >= capacity)
+                    {
+                        runs += writeRun(buffer, runPath(dir, depth, runs));
+                        checkTemp(dir, config.tempLimit);
+                    }
+                }
+            }
+
+            if (!buffer.empty()) {runs += writeRun(buffer, runPath(dir, depth, runs));}
+
+            checkTemp(dir, config.tempLimit);
+
+            using Head = std::pair<std::uint64_t, regi>;
+
+            std::vector<std::unique_ptr<Reader>> readers;
+            std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+
+            for (regi r = 0; r < runs; ++r)
+            {
+                readers.push_back(std::make_unique<Reader>(runPath(dir, depth, r)));
+
+                std::uint64_t v;
+
+                if (readers.back()->next(v)) {heads.emplace(v, r);}
+            }
+
+            // Neighbours of depth d lie at depth d - 1, d or d + 1, so only two frontiers need subtracting.
+            std::unique_ptr<Reader> current = std::make_unique<Reader>(frontierPath(dir, depth));
+            std::unique_ptr<Reader> previous = depth ? std::make_unique<Reader>(frontierPath(dir, depth - 1)) : nullptr;
+            std::uint64_t cur = 0, prev = 0;
+            bool hasCur = current->next(cur), hasPrev = previous && previous->next(prev);
+
+            fs::path tmp = frontierPath(dir, depth + 1).string() + ".tmp";
+            Writer out(tmp);
+            std::uint64_t last = UINT64_MAX;
+
+            while (!heads.empty())
+            {
+                auto [v, r] = heads.top();
+                heads.pop();
+
+                std::uint64_t following;
+
+                if (readers[r]->next(following)) {heads.emplace(following, r);}
+
+                if (v == last) {continue;}
+
+                last = v;
+
+                while (hasCur && cur < v)   {hasCur = current->next(cur);}
+                while (hasPrev && prev < v) {hasPrev = previous->next(prev);}
+
+                if ((hasCur && cur == v) || (hasPrev && prev == v)) {continue;}
+
+                out.push(v);
+            }
+
+            std::uint64_t count = out.close();
+
+            readers.clear();
+
+            for (regi r = 0; r < runs; ++r) {fs::remove(runPath(dir, depth, r));}
+
+            fs::rename(tmp, frontierPath(dir, depth + 1));
+
+            return count;
+        }
+
+        BfsStats run(const Space& space, const BfsConfig& config)
+        {
+            if (config.encoding != pruning::Encoding::NIBBLE && config.encoding != pruning::Encoding::MOD3)
+            {
+                throw std::invalid_argument(BFS_ENCODING);
+            }
+
+            fs::path dir(config.tempDir);
+            fs::create_directories(dir);
+
+            BfsStats stats;
+            Manifest m;
+
+            if (load(dir, m))
+            {
+                if (!fs::exists(config.outputPath)) {throw std::runtime_error(BFS_MANIFEST);}
+
+                stats.resumed = true;
+            }
+            else
+            {
+                std::vector<std::uint64_t> goals = space.goals;
+
+                std::sort(goals.begin(), goals.end());
+                goals.erase(std::unique(goals.begin(), goals.end()), goals.end());
+
+                createTable(config, space.size);
+
+                Writer out(frontierPath(dir, 0));
+
+                for (std::uint64_t g : goals) {out.push(g);}
+
+                out.close();
+
+                apply(config, frontierPath(dir, 0), 0);
+
+                m.perDepth = {goals.size()};
+                save(dir, m);
+            }
+
+            while (true)
+            {
+                byte d = m.depth;
+
+                if (!m.merged)
+                {
+                    std::uint64_t count = expand(space, config, dir, d);
+
+                    m.perDepth.resize(d + 1);
+                    m.perDepth.push_back(count);
+                    m.merged = true;
+                    save(dir, m);
+                }
+
+                if (m.perDepth[d + 1] == 0) {break;}
+
+                apply(config, frontierPath(dir, d + 1), d + 1);
+
+                if (d) {fs::remove(frontierPath(dir, d - 1));}
+
+                m.depth = d + 1;
+                m.merged = false;
+                save(dir, m);
+            }
+
+            for (regi d = 0; d < m.perDepth.size(); ++d) {fs::remove(frontierPath(dir, d));}
+
+            fs::remove(dir / "manifest");
+
+            m.perDepth.pop_back();
+
+            stats.depth = m.depth;
+            stats.perDepth = m.perDepth;
+
+            for (std::uint64_t c : m.perDepth) {stats.reached += c;}
+
+            return stats;
+        }
+
+        std::uint64_t edgePatternIndex(const CubieState& state, byte numEdges) noexcept
+        {
+            std::array<byte, 12> slotOf{};
+
+            for (byte slot = 0; slot < 12; ++slot) {slotOf[state.ep[slot]] = slot;}
+
+            std::uint64_t rank = 0, orient = 0;
+            std::uint16_t used = 0;
+
+            for (byte piece = 0; piece < numEdges; ++piece)
+            {
+                byte slot = slotOf[piece];
+                byte smaller = 0;
+
+                for (byte s = 0; s < slot; ++s) {smaller += !(used >> s & 1);}
+
+                used |= static_cast<std::uint16_t>(1u << slot);
+                rank = rank * (12 - piece) + smaller;
+                orient = orient << 1 | state.eo[slot];
+            }
+
+            return (rank << numEdges) | orient;
+        }
+
+        static CubieState edgePatternState(std::uint64_t index, byte numEdges) noexcept
+        {
+            CubieState state;
+            std::array<byte, 12> digits{};
+            std::uint64_t orient = index & ((std::uint64_t(1) << numEdges) - 1);
+            std::uint64_t rank = index >> numEdges;
+
+            for (byte piece = numEdges; piece-- > 0;)
+            {
+                digits[piece] = static_cast<byte>(rank % (12 - piece));
+                rank /= 12 - piece;
+            }
+
+            std::uint16_t used = 0;
+            state.ep.fill(UCHAR_MAX);
+
+            for (byte piece = 0; piece < numEdges; ++piece)
+            {
+                byte skip = digits[piece], slot = 0;
+
+                for (;; ++slot)
+                {
+                    if (used >> slot & 1) {continue;}
+                    if (skip-- == 0) {break;}
+                }
+
+                used |= static_cast<std::uint16_t>(1u << slot);
+                state.ep[slot] = piece;
+                state.eo[slot] = (orient >> (numEdges - 1 - piece)) & 1;
+            }
+
+            byte filler = numEdges;
+
+            for (byte slot = 0; slot < 12; ++slot)
+            {
+                if (state.ep[slot] == UCHAR_MAX) {state.ep[slot] = filler++;}
+            }
+
+            return state;
+        }
+
+        Space edgePatternSpace(byte numEdges)
+        {
+            if (numEdges == 0 || numEdges > 12) {throw std::invalid_argument("Edge pattern size must be 1 to 12");}
+
+            Space space;
+            space.size = std::uint64_t(1) << numEdges;
+
+            for (byte i = 0; i < numEdges; ++i) {space.size *= 12 - i;}
+
+            space.goals = {edgePatternIndex(CubieState(), numEdges)};
+            space.successors = [numEdges](std::uint64_t index, std::vector<std::uint64_t>& out)
+            {
+                const CubieState state = edgePatternState(index, numEdges);
+
+                for (Move move : search::allMoves)
+                {
+                    CubieState next = state;
+
+                    search::apply(next, move);
+                    out.push_back(edgePatternIndex(next, numEdges));
+                }
+            };
+
+            return space;
+        }
+
+        MappedTable::MappedTable(const std::string& path) :
+            data_(nullptr),
+            length_(0),
+            encoding_(pruning::Encoding::NONE),
+            entries_(0)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0) {throw std::runtime_error(BFS_IO);}
+
+            length_ = static_cast<regi>(::lseek(fd, 0, SEEK_END));
+            void* p = length_ >= tableHeaderSize ? ::mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+            ::close(fd);
+
+            if (p == MAP_FAILED) {throw std::runtime_error(BFS_IO);}
+
+            data_ = static_cast<const byte*>(p);
+
+            if (std::memcmp(data_, tableMagic, sizeof(tableMagic)) != 0)
+            {
+                ::munmap(const_cast<byte*>(data_), length_);
+
+                throw std::runtime_error(TABLE_FORMAT);
+            }
+
+            encoding_ = static_cast<pruning::Encoding>(data_[8]);
+
+            for (regi i = 0; i < 8; ++i) {entries_ |= static_cast<std::uint64_t>(data_[16 + i]) << (8 * i);}
+        }
+
+        MappedTable::~MappedTable() {::munmap(const_cast<byte*>(data_), length_);}
+
+        pruning::Encoding MappedTable::encoding() const noexcept {return encoding_;}
+        std::uint64_t MappedTable::entries() const noexcept {return entries_;}
+    }
+}
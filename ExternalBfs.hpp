@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Pruning.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace slvr
+{
+    // Disk-backed breadth-first search for distance tables that don't fit in memory. Each frontier is
+    // a sorted file of indices: successors are buffered up to the RAM limit, sorted into run files and
+    // merged with duplicate elimination against the two previous frontiers. Distances are streamed
+    // into a table file that MappedTable can map directly. A manifest in the temp directory records
+    // the last completed step so an interrupted run resumes where it stopped.
+    namespace external
+    {
+        struct Space
+        {
+            std::uint64_t size = 0;
+            std::vector<std::uint64_t> goals;
+            std::function<void(std::uint64_t, std::vector<std::uint64_t>&)> successors;
+        };
+
+        struct BfsConfig
+        {
+            std::string tempDir;
+            std::string outputPath;
+            regi ramLimit  = regi(1) << 30;
+            regi tempLimit = regi(64) << 30;
+            pruning::Encoding encoding = pruning::Encoding::NIBBLE;
+        };
+
+        struct BfsStats
+        {
+            byte depth = 0;
+            std::uint64_t reached = 0;
+            std::vector<std::uint64_t> perDepth;
+            bool resumed = false;
+        };
+
+        [[nodiscard]] BfsStats run(const Space& space, const BfsConfig& config);
+
+        // Positions and orientations of edge pieces 0 .. numEdges - 1: 12! / (12 - n)! * 2^n entries.
+        [[nodiscard]] Space edgePatternSpace(byte numEdges);
+        [[nodiscard]] std::uint64_t edgePatternIndex(const CubieState& state, byte numEdges) noexcept;
+
+        constexpr const char tableMagic[8] = {'S', 'L', 'V', 'R', 'P', 'D', 'B', '1'};
+        constexpr const regi tableHeaderSize = 64;
+
+        class MappedTable
+        {
+        private:
+            const byte* data_;
+            regi length_;
+            pruning::Encoding encoding_;
+            std::uint64_t entries_;
+
+        public:
+            explicit MappedTable(const std::string& path);
+            MappedTable(const MappedTable&) = delete;
+            MappedTable& operator=(const MappedTable&) = delete;
+            ~MappedTable();
+
+            [[nodiscard]] pruning::Encoding encoding() const noexcept;
+            [[nodiscard]] std::uint64_t entries() const noexcept;
+
+            [[nodiscard]] byte stored(std::uint64_t index) const noexcept
+            {
+                const byte* table = data_ + tableHeaderSize;
+
+                if (encoding_ == pruning::Encoding::NIBBLE) {return (table[index >> 1] >> ((index & 1) * 4)) & 15;}
+
+                return (table[index >> 2] >> ((index & 3) * 2)) & 3;
+            }
+        };
+    }
+}
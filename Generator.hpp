@@ -0,0 +1,120 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace slvr
+{
+    // Minimal lazy generator for compilers without std::generator. Values are yielded by reference:
+    // the consumer sees the coroutine's own object, valid until the next increment. The coroutine
+    // only runs while the consumer is pulling.
+    template <class T>
+    class Generator
+    {
+    public:
+        struct promise_type
+        {
+            const T* value = nullptr;
+            std::exception_ptr error;
+
+            Generator get_return_object() noexcept
+            {
+                return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept {return {};}
+            std::suspend_always final_suspend()   const noexcept {return {};}
+
+            std::suspend_always yield_value(const T& v) noexcept
+            {
+                value = std::addressof(v);
+
+                return {};
+            }
+
+            void return_void() const noexcept {}
+            void unhandled_exception() noexcept {error = std::current_exception();}
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        class iterator
+        {
+        private:
+            handle_type handle_;
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using difference_type   = std::ptrdiff_t;
+            using value_type        = T;
+
+            iterator() noexcept : handle_(nullptr) {}
+            explicit iterator(handle_type handle) noexcept : handle_(handle) {}
+
+            [[nodiscard]] const T& operator*() const noexcept {return *handle_.promise().value;}
+            [[nodiscard]] const T* operator->() const noexcept {return handle_.promise().value;}
+
+            iterator& operator++()
+            {
+                resume(handle_);
+
+                return *this;
+            }
+
+            void operator++(int) {++*this;}
+
+            [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept {return !handle_ || handle_.done();}
+        };
+
+    private:
+        handle_type handle_;
+
+        explicit Generator(handle_type handle) noexcept : handle_(handle) {}
+
+        static void resume(handle_type handle)
+        {
+            handle.resume();
+
+            if (handle.done() && handle.promise().error)
+            {
+                std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+            }
+        }
+
+    public:
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
+
+        Generator(Generator&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+        Generator& operator=(Generator&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle_) {handle_.destroy();}
+
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+
+            return *this;
+        }
+
+        ~Generator()
+        {
+            if (handle_) {handle_.destroy();}
+        }
+
+        // Runs the coroutine up to its first yield. Only one pass is possible.
+        [[nodiscard]] iterator begin()
+        {
+            if (handle_ && !handle_.done()) {resume(handle_);}
+
+            return iterator(handle_);
+        }
+
+        [[nodiscard]] std::default_sentinel_t end() const noexcept {return {};}
+    };
+}
@@ -0,0 +1,416 @@
+#include "Goal.hpp"
+#include "Packed.hpp"
+#include "Solver.hpp"
+#include <functional>
+#include <map>
+
+namespace slvr
+{
+    namespace goal
+    {
+        GoalMask& GoalMask::corner(byte slot, Aspect aspect) noexcept
+        {
+            corners[slot] = aspect;
+
+            return *this;
+        }
+
+        GoalMask& GoalMask::edge(byte slot, Aspect aspect) noexcept
+        {
+            edges[slot] = aspect;
+
+            return *this;
+        }
+
+        GoalMask GoalMask::operator|(const GoalMask& other) const noexcept
+        {
+            GoalMask out;
+
+            for (byte i = 0; i < 8; ++i)  {out.corners[i] = static_cast<Aspect>(static_cast<byte>(corners[i]) | static_cast<byte>(other.corners[i]));}
+            for (byte i = 0; i < 12; ++i) {out.edges[i]   = static_cast<Aspect>(static_cast<byte>(edges[i])   | static_cast<byte>(other.edges[i]));}
+
+            return out;
+        }
+
+        bool GoalMask::satisfied(const CubieState& s) const noexcept
+        {
+            for (byte i = 0; i < 8; ++i)
+            {
+                if (has(corners[i], Aspect::PERMUTATION) && s.cp[i] != i) {return false;}
+                if (has(corners[i], Aspect::ORIENTATION) && s.co[i] != 0) {return false;}
+            }
+
+            for (byte i = 0; i < 12; ++i)
+            {
+                if (has(edges[i], Aspect::PERMUTATION) && s.ep[i] != i) {return false;}
+                if (has(edges[i], Aspect::ORIENTATION) && s.eo[i] != 0) {return false;}
+            }
+
+            return true;
+        }
+
+        bool GoalMask::empty() const noexcept
+        {
+            return *this == GoalMask();
+        }
+
+        GoalMask full() noexcept
+        {
+            GoalMask mask;
+
+            mask.corners.fill(Aspect::BOTH);
+            mask.edges.fill(Aspect::BOTH);
+
+            return mask;
+        }
+
+        GoalMask cross() noexcept
+        {
+            return GoalMask().edge(8).edge(9).edge(10).edge(11);
+        }
+
+        GoalMask f2lSlot(byte slot) noexcept
+        {
+            return GoalMask().edge(4 + slot).corner(4 + slot);
+        }
+
+        GoalMask f2l() noexcept
+        {
+            return cross() | f2lSlot(0) | f2lSlot(1) | f2lSlot(2) | f2lSlot(3);
+        }
+
+        GoalMask oll() noexcept
+        {
+            GoalMask mask = f2l();
+
+            for (byte i = 0; i < 4; ++i)
+            {
+                mask.corner(i, Aspect::ORIENTATION);
+                mask.edge(i, Aspect::ORIENTATION);
+            }
+
+            return mask;
+        }
+
+        GoalMask pll() noexcept {return full();}
+
+        // Where a single piece goes under each move: coordinate position * base + orientation, 24
+        // values for both corners (base 3) and edges (base 2).
+        struct PieceMoves
+        {
+            std::array<std::array<byte, 24>, 18> corner{};
+            std::array<std::array<byte, 24>, 18> edge{};
+        };
+
+        static const PieceMoves& pieceMoves()
+        {
+            static const PieceMoves table = []
+            {
+                PieceMoves t;
+
+                for (byte m = 0; m < 18; ++m)
+                {
+                    const search::MoveDef& def = search::moveDefs[m];
+
+                    for (byte to = 0; to < 8; ++to)
+                    {
+                        byte from = def.cornerSrc[to];
+
+                        for (byte o = 0; o < 3; ++o) {t.corner[m][from * 3 + o] = static_cast<byte>(to * 3 + (o + def.twist[to]) % 3);}
+                    }
+
+                    for (byte to = 0; to < 12; ++to)
+                    {
+                        byte from = def.edgeSrc[to];
+
+                        for (byte o = 0; o < 2; ++o) {t.edge[m][from * 2 + o] = static_cast<byte>(to * 2 + (o ^ def.flip[to]));}
+                    }
+                }
+
+                return t;
+            }();
+
+            return table;
+        }
+
+        static constexpr regi groupEntries(byte count) noexcept
+        {
+            regi n = 1;
+
+            for (byte i = 0; i < count; ++i) {n *= 24;}
+
+            return n;
+        }
+
+        static regi pieceCoordinate(const CubieState& s, byte piece, bool oriented) noexcept
+        {
+            if (piece < 8)
+            {
+                byte slot = static_cast<byte>(std::find(s.cp.begin(), s.cp.end(), piece) - s.cp.begin());
+
+                return slot * 3 + (oriented ? s.co[slot] : 0);
+            }
+
+            byte slot = static_cast<byte>(std::find(s.ep.begin(), s.ep.end(), piece - 8) - s.ep.begin());
+
+            return slot * 2 + (oriented ? s.eo[slot] : 0);
+        }
+
+        static regi partIndex(const Heuristic::Part& part, const CubieState& s) noexcept
+        {
+            if (part.count == 0)
+            {
+                return part.edges ? coord::orientationRank<12, 2>(s.eo) : coord::orientationRank<8, 3>(s.co);
+            }
+
+            regi index = 0;
+
+            for (byte i = part.count; i-- > 0;) {index = index * 24 + pieceCoordinate(s, part.pieces[i], part.oriented[i]);}
+
+            return index;
+        }
+
+        // Distances for a group of pieces. Each piece moves independently, so successors are computed
+        // coordinate by coordinate from the single-piece tables.
+        static std::vector<byte> groupDistances(const Heuristic::Part& part)
+        {
+            const PieceMoves& moves = pieceMoves();
+            regi n = groupEntries(part.count);
+
+            std::vector<byte> dist(n, pruning::unreachable);
+            std::vector<std::uint32_t> frontier{static_cast<std::uint32_t>(partIndex(part, CubieState()))}, next;
+
+            dist[frontier[0]] = 0;
+
+            for (byte depth = 0; !frontier.empty(); ++depth)
+            {
+                next.clear();
+
+                for (std::uint32_t i : frontier)
+                {
+                    for (byte m = 0; m < 18; ++m)
+                    {
+                        regi rest = i, successor = 0, scale = 1;
+
+                        for (byte p = 0; p < part.count; ++p, rest /= 24, scale *= 24)
+                        {
+                            byte c = static_cast<byte>(rest % 24);
+                            byte moved = part.pieces[p] < 8 ? moves.corner[m][c] : moves.edge[m][c];
+
+                            if (!part.oriented[p]) {moved -= moved % (part.pieces[p] < 8 ? 3 : 2);}
+
+                            successor += moved * scale;
+                        }
+
+                        if (dist[successor] == pruning::unreachable)
+                        {
+                            dist[successor] = depth + 1;
+                            next.push_back(static_cast<std::uint32_t>(successor));
+                        }
+                    }
+                }
+
+                frontier.swap(next);
+            }
+
+            return dist;
+        }
+
+        // Distances over every corner (or edge) orientation to the nearest one with zeros on slots.
+        static std::vector<byte> orientationDistances(bool edges, const std::vector<byte>& slots)
+        {
+            regi n = edges ? coord::numEdgeOrients : coord::numCornerOrients;
+
+            std::vector<byte> dist(n, pruning::unreachable);
+            std::vector<std::uint32_t> frontier, next;
+
+            for (regi i = 0; i < n; ++i)
+            {
+                CubieState s;
+
+                if (edges) {s.eo = coord::orientationUnrank<12, 2>(static_cast<std::uint32_t>(i));}
+                else       {s.co = coord::orientationUnrank<8, 3>(static_cast<std::uint32_t>(i));}
+
+                const byte* o = edges ? s.eo.data() : s.co.data();
+
+                if (std::all_of(slots.begin(), slots.end(), [o](byte slot) {return o[slot] == 0;}))
+                {
+                    dist[i] = 0;
+                    frontier.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+
+            Heuristic::Part part{nullptr, {}, {}, 0, edges};
+
+            for (byte depth = 0; !frontier.empty(); ++depth)
+            {
+                next.clear();
+
+                for (std::uint32_t i : frontier)
+                {
+                    CubieState s;
+
+                    if (edges) {s.eo = coord::orientationUnrank<12, 2>(i);}
+                    else       {s.co = coord::orientationUnrank<8, 3>(i);}
+
+                    for (Move move : search::allMoves)
+                    {
+                        CubieState child = s;
+
+                        search::apply(child, move);
+
+                        regi j = partIndex(part, child);
+
+                        if (dist[j] == pruning::unreachable)
+                        {
+                            dist[j] = depth + 1;
+                            next.push_back(static_cast<std::uint32_t>(j));
+                        }
+                    }
+                }
+
+                frontier.swap(next);
+            }
+
+            return dist;
+        }
+
+        struct Cache
+        {
+            std::mutex mtx;
+            std::map<std::vector<byte>, std::unique_ptr<pruning::PruningTable>> tables;
+        };
+
+        static Cache& cache()
+        {
+            static Cache c;
+
+            return c;
+        }
+
+        static const pruning::PruningTable* cachedTable(const std::vector<byte>& key, const std::function<std::vector<byte>()>& build)
+        {
+            Cache& c = cache();
+            std::lock_guard<std::mutex> lock(c.mtx);
+
+            auto it = c.tables.find(key);
+
+            if (it == c.tables.end())
+            {
+                it = c.tables.emplace(key, std::make_unique<pruning::PruningTable>(pruning::Encoding::NIBBLE, build())).first;
+            }
+
+            return it->second.get();
+        }
+
+        Heuristic::Heuristic(std::vector<Part> parts) noexcept : parts_(std::move(parts)) {}
+
+        byte Heuristic::next(const CubieState& state, byte) const noexcept
+        {
+            byte h = 0;
+
+            for (const Part& part : parts_)
+            {
+                byte v = part.table->stored(partIndex(part, state));
+
+                if (v == 15) {return pruning::unreachable;}
+                if (v > h) {h = v;}
+            }
+
+            return h;
+        }
+
+        const std::vector<Heuristic::Part>& Heuristic::parts() const noexcept {return parts_;}
+
+        Heuristic heuristic(const GoalMask& mask)
+        {
+            std::vector<Heuristic::Part> parts;
+            std::vector<std::pair<byte, bool>> tracked;
+            std::vector<byte> cornerSlots, edgeSlots;
+
+            for (byte i = 0; i < 8; ++i)
+            {
+                if (has(mask.corners[i], Aspect::PERMUTATION)) {tracked.emplace_back(i, has(mask.corners[i], Aspect::ORIENTATION));}
+                else if (has(mask.corners[i], Aspect::ORIENTATION)) {cornerSlots.push_back(i);}
+            }
+
+            for (byte i = 0; i < 12; ++i)
+            {
+                if (has(mask.edges[i], Aspect::PERMUTATION)) {tracked.emplace_back(8 + i, has(mask.edges[i], Aspect::ORIENTATION));}
+                else if (has(mask.edges[i], Aspect::ORIENTATION)) {edgeSlots.push_back(i);}
+            }
+
+            for (regi first = 0; first < tracked.size(); first += maxGroupPieces)
+            {
+                Heuristic::Part part{nullptr, {}, {}, 0, false};
+                std::vector<byte> key{0};
+
+                for (regi i = first; i < tracked.size() && part.count < maxGroupPieces; ++i, ++part.count)
+                {
+                    part.pieces[part.count] = tracked[i].first;
+                    part.oriented[part.count] = tracked[i].second;
+                    key.push_back(tracked[i].first);
+                    key.push_back(tracked[i].second);
+                }
+
+                part.table = cachedTable(key, [&part] {return groupDistances(part);});
+                parts.push_back(part);
+            }
+
+            for (bool edges : {false, true})
+            {
+                const std::vector<byte>& slots = edges ? edgeSlots : cornerSlots;
+
+                if (slots.empty()) {continue;}
+
+                std::vector<byte> key{static_cast<byte>(edges ? 2 : 1)};
+
+                key.insert(key.end(), slots.begin(), slots.end());
+
+                Heuristic::Part part{nullptr, {}, {}, 0, edges};
+
+                part.table = cachedTable(key, [edges, &slots] {return orientationDistances(edges, slots);});
+                parts.push_back(part);
+            }
+
+            return Heuristic(std::move(parts));
+        }
+
+        regi cachedTables()
+        {
+            Cache& c = cache();
+            std::lock_guard<std::mutex> lock(c.mtx);
+
+            return c.tables.size();
+        }
+
+        std::optional<std::vector<Move>> solve(const Cube& cube, const GoalMask& mask, regi maxLength, const SearchLimits& limits)
+        {
+            const CubieState start(cube);
+            const Heuristic h = heuristic(mask);
+            auto goal = [&mask](const CubieState& s) {return mask.satisfied(s);};
+
+            std::atomic<bool> solutionFound(false);
+            SearchContext ctx(solutionFound, limits);
+            std::vector<Move> path;
+
+            for (regi length = h.initial(start); length <= std::min(maxLength, search::maxSearchDepth); ++length)
+            {
+                if (search::run<thistlethwaite::g0Moves>(start, length, cube.lastFace(), cube.secondLastFace(), path, ctx, goal, h))
+                {
+                    return path;
+                }
+
+                if (ctx.interrupted()) {break;}
+            }
+
+            return std::nullopt;
+        }
+
+        Generator<std::vector<Move>> solutions(const Cube& cube, const GoalMask& mask, regi maxLength, const SearchLimits& limits)
+        {
+            return search::enumerate<thistlethwaite::g0Moves>(CubieState(cube), maxLength, cube.lastFace(), cube.secondLastFace(), limits,
+                                                              [mask](const CubieState& s) {return mask.satisfied(s);}, heuristic(mask));
+        }
+    }
+}
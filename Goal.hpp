@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Search.hpp"
+#include "Pruning.hpp"
+#include <optional>
+
+namespace slvr
+{
+    // Partial goals: which cubie slots must be solved, and whether the piece in the slot must be the
+    // right one, be oriented, or both. Optimal search towards a mask uses small pattern tables over
+    // the pieces the mask tracks, built on first use and shared between masks.
+    namespace goal
+    {
+        enum class Aspect : byte
+        {
+            NONE        = 0,
+            ORIENTATION = 1,
+            PERMUTATION = 2,
+            BOTH        = 3
+        };
+
+        [[nodiscard]] constexpr bool has(Aspect aspect, Aspect flag) noexcept
+        {
+            return static_cast<byte>(aspect) & static_cast<byte>(flag);
+        }
+
+        struct GoalMask
+        {
+            std::array<Aspect, 8>  corners{};
+            std::array<Aspect, 12> edges{};
+
+            GoalMask& corner(byte slot, Aspect aspect = Aspect::BOTH) noexcept;
+            GoalMask& edge(byte slot, Aspect aspect = Aspect::BOTH) noexcept;
+
+            // Slot-wise union: a slot keeps every aspect either mask asks for.
+            [[nodiscard]] GoalMask operator|(const GoalMask& other) const noexcept;
+
+            [[nodiscard]] bool satisfied(const CubieState& state) const noexcept;
+            [[nodiscard]] bool empty() const noexcept;
+
+            [[nodiscard]] bool operator==(const GoalMask& other) const noexcept = default;
+        };
+
+        // Masks for the usual CFOP stages, built on the D layer. Slot k pairs edge 4 + k with corner
+        // 4 + k: 0 BR/DRB, 1 FR/DFR, 2 FL/DLF, 3 BL/DBL.
+        [[nodiscard]] GoalMask full() noexcept;
+        [[nodiscard]] GoalMask cross() noexcept;
+        [[nodiscard]] GoalMask f2lSlot(byte slot) noexcept;
+        [[nodiscard]] GoalMask f2l() noexcept;
+        [[nodiscard]] GoalMask oll() noexcept;
+        [[nodiscard]] GoalMask pll() noexcept;
+
+        constexpr const byte maxGroupPieces = 4;
+
+        // Maximum over one table per group of at most maxGroupPieces tracked pieces, plus one table
+        // each for the corner and edge slots where only orientation counts.
+        class Heuristic
+        {
+        public:
+            struct Part
+            {
+                const pruning::PruningTable* table;
+                std::array<byte, maxGroupPieces> pieces;  // corners 0-7, edges 8-19
+                std::array<bool, maxGroupPieces> oriented;
+                byte count;                                // 0 for an orientation table
+                bool edges;                                // orientation tables only
+            };
+
+        private:
+            std::vector<Part> parts_;
+
+        public:
+            explicit Heuristic(std::vector<Part> parts) noexcept;
+
+            [[nodiscard]] byte initial(const CubieState& state) const noexcept {return next(state, 0);}
+            [[nodiscard]] byte next(const CubieState& state, byte parent) const noexcept;
+
+            [[nodiscard]] const std::vector<Part>& parts() const noexcept;
+        };
+
+        // Builds (or fetches from the cache) the tables for mask.
+        [[nodiscard]] Heuristic heuristic(const GoalMask& mask);
+        [[nodiscard]] regi cachedTables();
+
+        // Shortest move sequence bringing cube to a state satisfying mask, if one exists within
+        // maxLength and the limits.
+        [[nodiscard]] std::optional<std::vector<Move>> solve(const Cube& cube, const GoalMask& mask, regi maxLength = 20,
+                                                             const SearchLimits& limits = {});
+
+        // Every distinct sequence of at most maxLength moves reaching mask, shortest first.
+        [[nodiscard]] Generator<std::vector<Move>> solutions(const Cube& cube, const GoalMask& mask, regi maxLength,
+                                                             const SearchLimits& limits = {});
+    }
+}
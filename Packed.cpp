@@ -0,0 +1,59 @@
+#include "Packed.hpp"
+
+#define PACKED_RANGE "Packed cube out of range"
+
+namespace slvr
+{
+    PackedCube pack(const Cube& cube) noexcept
+    {
+        PackedCube packed;
+
+        packed.corners = coord::permutationRank(cube.cornerPositions()) * coord::numCornerOrients
+                       + coord::orientationRank<8, 3>(cube.cornerOrientations());
+
+        packed.edges = static_cast<std::uint64_t>(coord::permutationRank(cube.edgePositions())) * coord::numEdgeOrients
+                     + coord::orientationRank<12, 2>(cube.edgeOrientations());
+
+        return packed;
+    }
+
+    Cube unpack(const PackedCube& packed)
+    {
+        std::uint32_t cornerPerm = packed.corners / coord::numCornerOrients;
+        std::uint64_t edgePerm   = packed.edges   / coord::numEdgeOrients;
+
+        if (cornerPerm >= coord::numCornerPerms || edgePerm >= coord::numEdgePerms) {throw std::invalid_argument(PACKED_RANGE);}
+
+        return Cube(coord::permutationUnrank<8>(cornerPerm),
+                    coord::orientationUnrank<8, 3>(packed.corners % coord::numCornerOrients),
+                    coord::permutationUnrank<12>(static_cast<std::uint32_t>(edgePerm)),
+                    coord::orientationUnrank<12, 2>(static_cast<std::uint32_t>(packed.edges % coord::numEdgeOrients)));
+    }
+
+    void writePacked(const PackedCube& packed, byte* out) noexcept
+    {
+        for (regi i = 0; i < 4; ++i) {out[i]     = static_cast<byte>(packed.corners >> (8 * i));}
+        for (regi i = 0; i < 8; ++i) {out[4 + i] = static_cast<byte>(packed.edges   >> (8 * i));}
+    }
+
+    PackedCube readPacked(const byte* in) noexcept
+    {
+        PackedCube packed;
+
+        for (regi i = 0; i < 4; ++i) {packed.corners |= static_cast<std::uint32_t>(in[i])     << (8 * i);}
+        for (regi i = 0; i < 8; ++i) {packed.edges   |= static_cast<std::uint64_t>(in[4 + i]) << (8 * i);}
+
+        return packed;
+    }
+
+    std::size_t PackedCubeHash::operator()(const PackedCube& packed) const noexcept
+    {
+        std::uint64_t h = packed.edges * 0x9E3779B97F4A7C15ull ^ packed.corners;
+
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+
+        return static_cast<std::size_t>(h);
+    }
+}
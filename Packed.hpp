@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Cube.hpp"
+#include <compare>
+#include <cstdint>
+
+namespace slvr
+{
+    namespace coord
+    {
+        template <regi N>
+        [[nodiscard]] constexpr std::uint32_t permutationRank(const std::array<byte, N>& perm) noexcept
+        {
+            std::uint32_t rank = 0;
+
+            for (regi i = 0; i < N; ++i)
+            {
+                std::uint32_t smaller = 0;
+
+                for (regi j = i + 1; j < N; ++j)
+                {
+                    if (perm[j] < perm[i]) {++smaller;}
+                }
+
+                rank = rank * static_cast<std::uint32_t>(N - i) + smaller;
+            }
+
+            return rank;
+        }
+
+        template <regi N>
+        [[nodiscard]] constexpr std::array<byte, N> permutationUnrank(std::uint32_t rank) noexcept
+        {
+            std::array<byte, N> digits{};
+            std::array<byte, N> perm{};
+
+            for (regi i = N; i-- > 0;)
+            {
+                digits[i] = static_cast<byte>(rank % (N - i));
+                rank /= static_cast<std::uint32_t>(N - i);
+            }
+
+            std::array<bool, N> used{};
+
+            for (regi i = 0; i < N; ++i)
+            {
+                byte skip = digits[i];
+
+                for (byte v = 0; v < N; ++v)
+                {
+                    if (used[v]) {continue;}
+                    if (skip-- == 0) {perm[i] = v; used[v] = true; break;}
+                }
+            }
+
+            return perm;
+        }
+
+        // The last orientation is implied by the others, so only the first N - 1 digits are ranked.
+        template <regi N, byte Base>
+        [[nodiscard]] constexpr std::uint32_t orientationRank(const std::array<byte, N>& orient) noexcept
+        {
+            std::uint32_t rank = 0;
+
+            for (regi i = 0; i + 1 < N; ++i) {rank = rank * Base + orient[i];}
+
+            return rank;
+        }
+
+        template <regi N, byte Base>
+        [[nodiscard]] constexpr std::array<byte, N> orientationUnrank(std::uint32_t rank) noexcept
+        {
+            std::array<byte, N> orient{};
+            regi sum = 0;
+
+            for (regi i = N - 1; i-- > 0;)
+            {
+                orient[i] = static_cast<byte>(rank % Base);
+                rank /= Base;
+                sum += orient[i];
+            }
+
+            orient[N - 1] = static_cast<byte>((Base - sum % Base) % Base);
+
+            return orient;
+        }
+
+        constexpr const std::uint32_t numCornerPerms  = 40320,
+                                      numCornerOrients = 2187,
+                                      numEdgePerms    = 479001600,
+                                      numEdgeOrients  = 2048;
+    }
+
+    // Ranked cubie state: 27 bits of corner data and 40 bits of edge data.
+    struct PackedCube
+    {
+        std::uint32_t corners = 0;
+        std::uint64_t edges   = 0;
+
+        auto operator<=>(const PackedCube& other) const noexcept = default;
+    };
+
+    constexpr const regi packedCubeSize = 12;
+
+    [[nodiscard]] PackedCube pack(const Cube& cube) noexcept;
+    [[nodiscard]] Cube unpack(const PackedCube& packed);
+
+    void writePacked(const PackedCube& packed, byte* out) noexcept;
+    [[nodiscard]] PackedCube readPacked(const byte* in) noexcept;
+
+    struct PackedCubeHash
+    {
+        [[nodiscard]] std::size_t operator()(const PackedCube& packed) const noexcept;
+    };
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include "Search.hpp"
+#include "Trace.hpp"
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace slvr
+{
+    namespace search
+    {
+        // Iterative deepening A* shared by a pool of workers. Each iteration starts from a single root
+        // task; whenever a worker is waiting, busy workers hand over the untried siblings at their
+        // shallowest open frame as new tasks, so the tree is split wherever the work is. Workers
+        // lower a shared next-iteration bound as they cut nodes off, and prune against a shared best
+        // length once any solution is known.
+        template <const auto& Moves, class Goal, class Heuristic = NoHeuristic>
+        class ParallelSearch
+        {
+        private:
+            static constexpr byte n = static_cast<byte>(std::tuple_size_v<std::decay_t<decltype(Moves)>>);
+            static constexpr regi none = std::numeric_limits<regi>::max();
+
+            // Subtrees with fewer remaining levels than this are not worth handing over.
+            static constexpr regi minSplitDepth = 3;
+
+            struct Task
+            {
+                CubieState state;
+                std::array<Move, maxSearchDepth> moves;
+                byte length;
+                byte last;
+                byte secondLast;
+                byte h;
+            };
+
+            const Goal& goal_;
+            const Heuristic& heuristic_;
+            const SearchLimits& limits_;
+
+            std::mutex mtx_;
+            std::condition_variable work_;
+            std::condition_variable idle_;
+            std::vector<Task> tasks_;
+            regi active_;
+            bool finished_;
+
+            std::atomic<regi> waiting_;
+            std::atomic<regi> queued_;
+            std::atomic<regi> bound_;
+            std::atomic<regi> nextBound_;
+            std::atomic<regi> best_;
+            std::atomic<bool> solutionFound_;
+            std::vector<Move> solution_;
+
+            static void lower(std::atomic<regi>& value, regi candidate) noexcept
+            {
+                regi current = value.load(std::memory_order_relaxed);
+
+                while (candidate < current && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {}
+            }
+
+            void found(const std::array<Move, maxSearchDepth>& moves, regi length)
+            {
+                SLVR_TRACE_INSTANT("solution", static_cast<std::int64_t>(length));
+
+                lower(best_, length);
+
+                std::lock_guard<std::mutex> lock(mtx_);
+
+                if (!solutionFound_.load() || length < solution_.size())
+                {
+                    solution_.assign(moves.begin(), moves.begin() + length);
+                }
+
+                solutionFound_.store(true);
+            }
+
+            void push(std::vector<Task>& donated)
+            {
+                if (donated.empty()) {return;}
+
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+
+                    for (Task& task : donated) {tasks_.push_back(std::move(task));}
+
+                    queued_.store(tasks_.size(), std::memory_order_relaxed);
+                }
+
+                work_.notify_all();
+                donated.clear();
+            }
+
+            // Kernel policy for one task: bounds against the iteration's bound and the best length
+            // found so far, and a split whenever a worker is waiting.
+            struct TaskPolicy : CountPolicy<Goal>
+            {
+                ParallelSearch& search;
+                const Task& task;
+                std::vector<Task>& donated;
+                regi bound;
+
+                [[nodiscard]] bool admit(regi length, std::uint32_t, byte h) const noexcept
+                {
+                    // Not a goal, so at least one more move is needed whatever the heuristic says.
+                    regi f = task.length + length + std::max<regi>(h, 1);
+
+                    if (f > bound) {lower(search.nextBound_, f); return false;}
+
+                    return f < search.best_.load(std::memory_order_relaxed);
+                }
+
+                template <class Kernel>
+                void poll(Kernel& kernel)
+                {
+                    if (search.waiting_.load(std::memory_order_relaxed) > search.queued_.load(std::memory_order_relaxed))
+                    {
+                        search.split(kernel, task, donated);
+                    }
+                }
+            };
+
+            // Hands the untried children of the shallowest open frame to waiting workers.
+            template <class Kernel>
+            void split(Kernel& kernel, const Task& task, std::vector<Task>& donated)
+            {
+                const regi bound = bound_.load(std::memory_order_relaxed);
+                const regi base = task.length;
+
+                for (regi k = 0; k <= kernel.depth(); ++k)
+                {
+                    auto& frame = kernel.frame(k);
+
+                    if (frame.next == frame.count) {continue;}
+                    if (base + k + minSplitDepth > bound) {return;}
+
+                    for (byte j = frame.next; j < frame.count; ++j)
+                    {
+                        byte i = frame.order[j];
+                        byte h = j < frame.reports ? 0 : frame.h[i];
+                        Task child{frame.children[i], task.moves, static_cast<byte>(base + k + 1), static_cast<byte>(static_cast<byte>(Moves[i]) / 3),
+                                   frame.last, h};
+
+                        std::copy(kernel.moves().begin(), kernel.moves().begin() + k, child.moves.begin() + base);
+                        child.moves[base + k] = Moves[i];
+                        donated.push_back(child);
+                    }
+
+                    frame.next = frame.count;
+
+                    SLVR_TRACE_INSTANT("split", static_cast<std::int64_t>(donated.size()));
+
+                    push(donated);
+
+                    return;
+                }
+            }
+
+            void explore(const Task& task, SearchContext& ctx, std::vector<Task>& donated)
+            {
+                SLVR_TRACE_SPAN("explore", static_cast<std::int64_t>(task.length));
+
+                if (goal_(task.state)) {found(task.moves, task.length); return;}
+
+                TaskPolicy policy{{goal_}, *this, task, donated, bound_.load(std::memory_order_relaxed)};
+                Kernel<Moves, TaskPolicy, Heuristic> kernel(task.state, task.h, static_cast<Face>(task.last), static_cast<Face>(task.secondLast),
+                                                            maxSearchDepth - task.length, policy, heuristic_, ctx);
+
+                if (kernel.next() != Event::GOAL) {return;}
+
+                std::array<Move, maxSearchDepth> moves = task.moves;
+
+                std::copy(kernel.moves().begin(), kernel.moves().begin() + kernel.length(), moves.begin() + task.length);
+                found(moves, task.length + kernel.length());
+            }
+
+            void work()
+            {
+                SLVR_TRACE_SPAN("worker");
+
+                SearchContext ctx(solutionFound_, limits_);
+                std::vector<Task> donated;
+
+                std::unique_lock<std::mutex> lock(mtx_);
+
+                while (true)
+                {
+                    waiting_.fetch_add(1, std::memory_order_relaxed);
+                    work_.wait(lock, [this] {return finished_ || !tasks_.empty();});
+                    waiting_.fetch_sub(1, std::memory_order_relaxed);
+
+                    if (finished_) {return;}
+
+                    Task task = std::move(tasks_.back());
+
+                    tasks_.pop_back();
+                    queued_.store(tasks_.size(), std::memory_order_relaxed);
+                    ++active_;
+                    lock.unlock();
+
+                    if (!ctx.stopped()) {explore(task, ctx, donated);}
+                    else                {SLVR_TRACE_INSTANT("cancelled", static_cast<std::int64_t>(task.length));}
+
+                    lock.lock();
+
+                    if (--active_ == 0 && tasks_.empty()) {idle_.notify_one();}
+                }
+            }
+
+        public:
+            // Any h at least this large means the goal can't be reached.
+            static constexpr byte unreachableBound = UCHAR_MAX;
+
+            ParallelSearch(const Goal& goal, const Heuristic& heuristic, const SearchLimits& limits) noexcept :
+                goal_(goal),
+                heuristic_(heuristic),
+                limits_(limits),
+                active_(0),
+                finished_(false),
+                waiting_(0),
+                queued_(0),
+                bound_(0),
+                nextBound_(none),
+                best_(none),
+                solutionFound_(false)
+            {}
+
+            // Shortest move sequence of at most maxDepth moves from start to a goal state, if one is
+            // found before the limits stop the search.
+            std::optional<std::vector<Move>> run(const CubieState& start, regi maxDepth, Face last, Face secondLast, regi threads)
+            {
+                if (goal_(start)) {return std::vector<Move>{};}
+
+                byte h = heuristic_.initial(start);
+
+                if (maxDepth > maxSearchDepth) {maxDepth = maxSearchDepth;}
+                if (h > maxDepth) {return std::nullopt;}
+                if (threads == 0) {threads = std::max(1u, std::thread::hardware_concurrency());}
+
+                best_.store(maxDepth + 1);
+
+                std::vector<std::thread> workers;
+
+                for (regi t = 0; t < threads; ++t) {workers.emplace_back([this] {work();});}
+
+                for (regi bound = std::max<regi>(h, 1); bound <= maxDepth;)
+                {
+                    SLVR_TRACE_SPAN("iteration", static_cast<std::int64_t>(bound));
+
+                    std::unique_lock<std::mutex> lock(mtx_);
+
+                    bound_.store(bound);
+                    nextBound_.store(none);
+                    tasks_.push_back(Task{start, {}, 0, static_cast<byte>(last), static_cast<byte>(secondLast), h});
+                    queued_.store(1, std::memory_order_relaxed);
+                    work_.notify_one();
+                    idle_.wait(lock, [this] {return active_ == 0 && tasks_.empty();});
+
+                    if (solutionFound_.load() || limits_.reached()) {break;}
+
+                    bound = nextBound_.load();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+
+                    finished_ = true;
+                }
+
+                work_.notify_all();
+
+                for (std::thread& t : workers) {t.join();}
+
+                if (!solutionFound_.load()) {return std::nullopt;}
+
+                return solution_;
+            }
+        };
+
+        // threads == 0 uses every hardware thread.
+        template <const auto& Moves, class Goal, class Heuristic = NoHeuristic>
+        std::optional<std::vector<Move>> parallelRun(const CubieState& start, regi maxDepth, Face last, Face secondLast,
+                                                     const SearchLimits& limits, const Goal& goal, const Heuristic& heuristic = {},
+                                                     regi threads = 0)
+        {
+            ParallelSearch<Moves, Goal, Heuristic> search(goal, heuristic, limits);
+
+            return search.run(start, maxDepth, last, secondLast, threads);
+        }
+    }
+}
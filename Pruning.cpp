@@ -0,0 +1,491 @@
+#include "Pruning.hpp"
+#include "Packed.hpp"
+#include "Solver.hpp"
+#include <functional>
+
+namespace slvr
+{
+    namespace pruning
+    {
+        static constexpr const std::array<byte, 4> eSlicePieces {4, 5, 6, 7};
+        static constexpr const std::array<byte, 4> mSlicePieces {0, 2, 8, 10};
+        static constexpr const std::array<byte, 4> sSlicePieces {1, 3, 9, 11};
+
+        static constexpr const std::array<byte, 12> allEdgeSlots {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+        static constexpr const std::array<byte,  8> udEdgeSlots  {0, 1, 2, 3, 8, 9, 10, 11};
+
+        static constexpr regi choose(regi n, regi k) noexcept
+        {
+            if (k > n) {return 0;}
+
+            regi r = 1;
+
+            for (regi i = 1; i <= k; ++i) {r = r * (n - k + i) / i;}
+
+            return r;
+        }
+
+        static constexpr bool contains(const std::array<byte, 4>& set, byte v) noexcept
+        {
+            return set[0] == v || set[1] == v || set[2] == v || set[3] == v;
+        }
+
+        // Rank of the slots among `slots` holding a piece of `pieces`, in the combinatorial number system.
+        template <regi N>
+        static regi combinationRank(const edge_arr& ep, const std::array<byte, N>& slots, const std::array<byte, 4>& pieces) noexcept
+        {
+            regi rank = 0, k = 0;
+
+            for (regi i = 0; i < N; ++i)
+            {
+                if (contains(pieces, ep[slots[i]])) {rank += choose(i, ++k);}
+            }
+
+            return rank;
+        }
+
+        template <regi N>
+        static void combinationSet(edge_arr& ep, const std::array<byte, N>& slots, const std::array<byte, 4>& pieces, regi rank) noexcept
+        {
+            std::array<bool, N> chosen{};
+
+            for (regi k = 4; k > 0; --k)
+            {
+                regi i = k - 1;
+
+                while (choose(i + 1, k) <= rank) {++i;}
+
+                chosen[i] = true;
+                rank -= choose(i, k);
+            }
+
+            std::array<byte, 12> others{};
+            regi numOthers = 0, next = 0;
+
+            for (byte piece = 0; piece < 12; ++piece)
+            {
+                if (!contains(pieces, piece) && std::find(slots.begin(), slots.end(), piece) != slots.end()) {others[numOthers++] = piece;}
+            }
+
+            regi o = 0;
+
+            for (regi i = 0; i < N; ++i)
+            {
+                ep[slots[i]] = chosen[i] ? pieces[next++] : others[o++];
+            }
+        }
+
+        static regi slicePermRank(const edge_arr& ep, const std::array<byte, 4>& slots) noexcept
+        {
+            std::array<byte, 4> local{};
+
+            for (byte i = 0; i < 4; ++i)
+            {
+                local[i] = static_cast<byte>(std::find(slots.begin(), slots.end(), ep[slots[i]]) - slots.begin());
+            }
+
+            return coord::permutationRank(local);
+        }
+
+        static void slicePermSet(edge_arr& ep, const std::array<byte, 4>& slots, regi rank) noexcept
+        {
+            std::array<byte, 4> local = coord::permutationUnrank<4>(static_cast<std::uint32_t>(rank));
+
+            for (byte i = 0; i < 4; ++i) {ep[slots[i]] = slots[local[i]];}
+        }
+
+        static regi halfTurnCornerRank(const corner_arr& cp) noexcept
+        {
+            const std::vector<corner_arr>& reachable = thistlethwaite::halfTurnCorners();
+
+            return std::lower_bound(reachable.begin(), reachable.end(), cp) - reachable.begin();
+        }
+
+        regi index(TableId id, const CubieState& s) noexcept
+        {
+            switch (id)
+            {
+                case TableId::PHASE0: return coord::orientationRank<12, 2>(s.eo);
+                case TableId::PHASE1: return coord::orientationRank<8, 3>(s.co) * 495 + combinationRank(s.ep, allEdgeSlots, eSlicePieces);
+                case TableId::PHASE2: return coord::permutationRank(s.cp) * 70 + combinationRank(s.ep, udEdgeSlots, mSlicePieces);
+                case TableId::PHASE3: return ((halfTurnCornerRank(s.cp) * 24 + slicePermRank(s.ep, mSlicePieces)) * 24
+                                             + slicePermRank(s.ep, sSlicePieces)) * 24 + slicePermRank(s.ep, eSlicePieces);
+                case TableId::CORNERS: return coord::permutationRank(s.cp) * coord::numCornerOrients + coord::orientationRank<8, 3>(s.co);
+            }
+
+            return 0;
+        }
+
+        struct Component
+        {
+            regi size;
+            std::function<regi(const CubieState&)> get;
+            std::function<void(CubieState&, regi)> set;
+        };
+
+        struct Spec
+        {
+            std::vector<Component> components;
+            std::vector<Move> moves;
+            std::function<bool(const CubieState&)> goal;
+        };
+
+        static Spec spec(TableId id)
+        {
+            Component eo{2048, [](const CubieState& s) -> regi {return coord::orientationRank<12, 2>(s.eo);},
+                               [](CubieState& s, regi v) {s.eo = coord::orientationUnrank<12, 2>(static_cast<std::uint32_t>(v));}};
+            Component co{2187, [](const CubieState& s) -> regi {return coord::orientationRank<8, 3>(s.co);},
+                               [](CubieState& s, regi v) {s.co = coord::orientationUnrank<8, 3>(static_cast<std::uint32_t>(v));}};
+            Component cp{40320, [](const CubieState& s) -> regi {return coord::permutationRank(s.cp);},
+                                [](CubieState& s, regi v) {s.cp = coord::permutationUnrank<8>(static_cast<std::uint32_t>(v));}};
+            Component eSlice{495, [](const CubieState& s) {return combinationRank(s.ep, allEdgeSlots, eSlicePieces);},
+                                  [](CubieState& s, regi v) {combinationSet(s.ep, allEdgeSlots, eSlicePieces, v);}};
+            Component mSlice{70, [](const CubieState& s) {return combinationRank(s.ep, udEdgeSlots, mSlicePieces);},
+                                 [](CubieState& s, regi v) {combinationSet(s.ep, udEdgeSlots, mSlicePieces, v);}};
+            Component cp96{96, [](const CubieState& s) {return halfTurnCornerRank(s.cp);},
+                               [](CubieState& s, regi v) {s.cp = thistlethwaite::halfTurnCorners()[v];}};
+
+            auto slicePerm = [](const std::array<byte, 4>& slots)
+            {
+                return Component{24, [&slots](const CubieState& s) {return slicePermRank(s.ep, slots);},
+                                      [&slots](CubieState& s, regi v) {slicePermSet(s.ep, slots, v);}};
+            };
+
+            using namespace thistlethwaite;
+
+            switch (id)
+            {
+                case TableId::PHASE0: return Spec{{eo}, {g0Moves.begin(), g0Moves.end()}, NextGroup<State::G0>()};
+                case TableId::PHASE1: return Spec{{co, eSlice}, {g1Moves.begin(), g1Moves.end()}, NextGroup<State::G1>()};
+                case TableId::PHASE2: return Spec{{cp, mSlice}, {g2Moves.begin(), g2Moves.end()}, NextGroup<State::G2>()};
+                case TableId::PHASE3: return Spec{{cp96, slicePerm(mSlicePieces), slicePerm(sSlicePieces), slicePerm(eSlicePieces)},
+                                                  {g3Moves.begin(), g3Moves.end()}, NextGroup<State::G3>()};
+                case TableId::CORNERS: return Spec{{cp, co}, {g0Moves.begin(), g0Moves.end()},
+                                                   [](const CubieState& s) {return s.cp == CubieState().cp && s.co == CubieState().co;}};
+            }
+
+            return Spec{};
+        }
+
+        regi entries(TableId id) noexcept
+        {
+            switch (id)
+            {
+                case TableId::PHASE0: return 2048;
+                case TableId::PHASE1: return 2187 * 495;
+                case TableId::PHASE2: return 40320 * 70;
+                case TableId::PHASE3: return 96 * 24 * 24 * 24;
+                case TableId::CORNERS: return regi(40320) * 2187;
+            }
+
+            return 0;
+        }
+
+        // Breadth-first search over the product of the table's coordinates, one byte per entry.
+        static std::vector<byte> distances(TableId id)
+        {
+            Spec s = spec(id);
+            regi n = entries(id), numMoves = s.moves.size(), numComponents = s.components.size();
+
+            std::vector<std::vector<std::uint32_t>> moveTables(numComponents);
+            std::vector<regi> stride(numComponents, 1);
+
+            for (regi c = numComponents; c-- > 0;)
+            {
+                const Component& comp = s.components[c];
+
+                if (c + 1 < numComponents) {stride[c] = stride[c + 1] * s.components[c + 1].size;}
+
+                moveTables[c].resize(comp.size * numMoves);
+
+                for (regi v = 0; v < comp.size; ++v)
+                {
+                    for (regi m = 0; m < numMoves; ++m)
+                    {
+                        CubieState state;
+
+                        comp.set(state, v);
+                        search::apply(state, s.moves[m]);
+
+                        moveTables[c][v * numMoves + m] = static_cast<std::uint32_t>(comp.get(state));
+                    }
+                }
+            }
+
+            std::vector<byte> dist(n, unreachable);
+            regi found = 0;
+
+            for (const corner_arr& corners : thistlethwaite::halfTurnCorners())
+            {
+                CubieState goal;
+
+                if (id == TableId::PHASE2) {goal.cp = corners;}
+
+                regi i = index(id, goal);
+
+                if (dist[i] == unreachable) {dist[i] = 0; ++found;}
+            }
+
+            for (byte depth = 0; found; ++depth)
+            {
+                found = 0;
+
+                for (regi i = 0; i < n; ++i)
+                {
+                    if (dist[i] != depth) {continue;}
+
+                    for (regi m = 0; m < numMoves; ++m)
+                    {
+                        regi next = 0, rest = i;
+
+                        for (regi c = 0; c < numComponents; ++c)
+                        {
+                            next += moveTables[c][(rest / stride[c]) * numMoves + m] * stride[c];
+                            rest %= stride[c];
+                        }
+
+                        if (dist[next] == unreachable) {dist[next] = depth + 1; ++found;}
+                    }
+                }
+            }
+
+            return dist;
+        }
+
+        PruningTable::PruningTable(Encoding encoding, const std::vector<byte>& distances) :
+            encoding_(encoding),
+            entries_(distances.size()),
+            bound_(0),
+            words_((bytesFor(encoding, distances.size()) + 7) / 8, 0)
+        {
+            if (encoding_ == Encoding::BIT)
+            {
+                std::array<regi, 256> histogram{};
+
+                for (byte d : distances) {++histogram[d];}
+
+                regi atLeast = entries_ - histogram[unreachable], best = 0;
+
+                for (regi d = 1; d < unreachable; ++d)
+                {
+                    atLeast -= histogram[d - 1];
+
+                    if (d * atLeast > best) {best = d * atLeast; bound_ = static_cast<byte>(d);}
+                }
+            }
+
+            for (regi i = 0; i < entries_; ++i)
+            {
+                byte d = distances[i];
+                std::uint64_t v;
+
+                switch (encoding_)
+                {
+                    case Encoding::NIBBLE: v = d == unreachable ? 15 : std::min<byte>(d, 14);          words_[i >> 4] |= v << ((i & 15) * 4); break;
+                    case Encoding::MOD3:   v = d == unreachable ? 3 : d % 3;                           words_[i >> 5] |= v << ((i & 31) * 2); break;
+                    case Encoding::BIT:    v = d != unreachable && d >= bound_ ? 1 : 0;                words_[i >> 6] |= v << (i & 63);       break;
+                    default: break;
+                }
+            }
+        }
+
+        regi PruningTable::bytesFor(Encoding encoding, regi entries) noexcept
+        {
+            switch (encoding)
+            {
+                case Encoding::NIBBLE: return (entries + 15) / 16 * 8;
+                case Encoding::MOD3:   return (entries + 31) / 32 * 8;
+                case Encoding::BIT:    return (entries + 63) / 64 * 8;
+                default:               return 0;
+            }
+        }
+
+        Encoding PruningTable::encoding() const noexcept {return encoding_;}
+        regi PruningTable::entries() const noexcept {return entries_;}
+        regi PruningTable::bytes() const noexcept {return words_.size() * 8;}
+        byte PruningTable::bound() const noexcept {return bound_;}
+        const std::uint64_t* PruningTable::data() const noexcept {return words_.data();}
+
+        TablePlan plan(const TableConfig& config) noexcept
+        {
+            constexpr std::array<TableId, numTables> priority {TableId::PHASE0, TableId::PHASE1, TableId::PHASE3,
+                                                               TableId::PHASE2, TableId::CORNERS};
+            TablePlan out;
+            regi n = config.optimal ? numTables : numTables - 1;
+
+            for (regi i = 0; i < n; ++i)
+            {
+                regi e = entries(priority[i]);
+                regi scratch = std::max(out.scratch, e);
+
+                for (Encoding enc : {Encoding::MOD3, Encoding::BIT})
+                {
+                    if (out.bytes + PruningTable::bytesFor(enc, e) + scratch <= config.memoryBudget)
+                    {
+                        out.encoding[static_cast<byte>(priority[i])] = enc;
+                        out.bytes += PruningTable::bytesFor(enc, e);
+                        out.scratch = scratch;
+                        break;
+                    }
+                }
+            }
+
+            for (regi i = 0; i < n; ++i)
+            {
+                byte t = static_cast<byte>(priority[i]);
+                regi e = entries(priority[i]);
+                regi extra = PruningTable::bytesFor(Encoding::NIBBLE, e) - PruningTable::bytesFor(out.encoding[t], e);
+
+                if (out.encoding[t] != Encoding::NONE && out.bytes + extra + out.scratch <= config.memoryBudget)
+                {
+                    out.encoding[t] = Encoding::NIBBLE;
+                    out.bytes += extra;
+                }
+            }
+
+            return out;
+        }
+
+        struct Registry
+        {
+            std::mutex mtx;
+            TableConfig config;
+            TablePlan plan = pruning::plan(config);
+            std::array<std::atomic<std::shared_ptr<const PruningTable>>, numTables> ready{};
+        };
+
+        static Registry& registry()
+        {
+            static Registry r;
+
+            return r;
+        }
+
+        void configure(const TableConfig& config)
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+
+            r.config = config;
+            r.plan = plan(config);
+
+            // Dropping the registry's reference frees a retired table as soon as no heuristic holds it.
+            for (byte t = 0; t < numTables; ++t)
+            {
+                std::shared_ptr<const PruningTable> built = r.ready[t].load();
+
+                if (built && built->encoding() != r.plan.encoding[t]) {r.ready[t].store(nullptr);}
+            }
+        }
+
+        TableConfig currentConfig()
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+
+            return r.config;
+        }
+
+        TablePlan currentPlan()
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+
+            return r.plan;
+        }
+
+        std::shared_ptr<const PruningTable> table(TableId id)
+        {
+            Registry& r = registry();
+            byte t = static_cast<byte>(id);
+
+            if (std::shared_ptr<const PruningTable> built = r.ready[t].load(std::memory_order_acquire)) {return built;}
+
+            std::lock_guard<std::mutex> lock(r.mtx);
+
+            if (std::shared_ptr<const PruningTable> built = r.ready[t].load()) {return built;}
+            if (r.plan.encoding[t] == Encoding::NONE) {return nullptr;}
+
+            std::shared_ptr<const PruningTable> built = std::make_shared<const PruningTable>(r.plan.encoding[t], distances(id));
+
+            r.ready[t].store(built, std::memory_order_release);
+
+            return built;
+        }
+
+        std::shared_ptr<const PruningTable> built(TableId id)
+        {
+            return registry().ready[static_cast<byte>(id)].load(std::memory_order_acquire);
+        }
+
+        void prepare()
+        {
+            for (byte t = 0; t < numTables; ++t) {static_cast<void>(table(static_cast<TableId>(t)));}
+        }
+
+        static byte decode(const PruningTable& t, TableId id, const CubieState& state)
+        {
+            byte v = t.stored(index(id, state));
+
+            switch (t.encoding())
+            {
+                case Encoding::NIBBLE: return v == 15 ? unreachable : v;
+                case Encoding::BIT:    return v ? t.bound() : 0;
+                default: break;
+            }
+
+            if (v == 3) {return unreachable;}
+
+            Spec s = spec(id);
+            CubieState current = state;
+            byte d = 0;
+
+            while (!s.goal(current))
+            {
+                byte want = (v + 2) % 3;
+                bool stepped = false;
+
+                for (Move move : s.moves)
+                {
+                    CubieState next = current;
+
+                    search::apply(next, move);
+
+                    if (t.stored(index(id, next)) == want) {current = next; v = want; stepped = true; break;}
+                }
+
+                if (!stepped) {return unreachable;}
+
+                ++d;
+            }
+
+            return d;
+        }
+
+        byte distance(TableId id, const CubieState& state)
+        {
+            std::shared_ptr<const PruningTable> t = table(id);
+
+            return t ? decode(*t, id, state) : 0;
+        }
+
+        Heuristic::Heuristic(TableId id, std::shared_ptr<const PruningTable> table) noexcept :
+            id_(id), owner_(std::move(table)), table_(owner_.get()) {}
+
+        byte Heuristic::initial(const CubieState& state) const
+        {
+            if (!table_) {return 0;}
+
+            return decode(*table_, id_, state);
+        }
+
+        Heuristic heuristic(TableId id) {return Heuristic(id, table(id));}
+
+        Heuristic heuristic(TableId id, const Deadline& deadline)
+        {
+            return Heuristic(id, deadline.unbounded() ? table(id) : built(id));
+        }
+
+        TableId phaseTable(byte phase) noexcept {return static_cast<TableId>(phase);}
+    }
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "Search.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace slvr
+{
+    namespace pruning
+    {
+        // NIBBLE stores the exact distance in 4 bits. MOD3 stores distance mod 3 in 2 bits; the exact
+        // value is recovered by walking towards the goal at the root and incrementally from the
+        // parent during search. BIT stores one bit meaning "distance >= bound".
+        enum class Encoding : byte
+        {
+            NONE,
+            BIT,
+            MOD3,
+            NIBBLE
+        };
+
+        enum class TableId : byte
+        {
+            PHASE0,  // edge orientation
+            PHASE1,  // corner orientation x E-slice edges
+            PHASE2,  // corner permutation x M-slice edges
+            PHASE3,  // half-turn corner permutation x slice edge permutations
+            CORNERS  // corner permutation x corner orientation, for optimal search
+        };
+
+        constexpr const byte numTables   = 5;
+        constexpr const byte unreachable = UCHAR_MAX;
+
+        class PruningTable
+        {
+        private:
+            Encoding encoding_;
+            regi entries_;
+            byte bound_;
+            std::vector<std::uint64_t> words_;
+
+        public:
+            PruningTable(Encoding encoding, const std::vector<byte>& distances);
+
+            [[nodiscard]] static regi bytesFor(Encoding encoding, regi entries) noexcept;
+
+            [[nodiscard]] Encoding encoding() const noexcept;
+            [[nodiscard]] regi entries() const noexcept;
+            [[nodiscard]] regi bytes() const noexcept;
+            [[nodiscard]] byte bound() const noexcept;
+
+            // Raw stored value: a distance, a distance mod 3 or a bit; 15 or 3 marks unreachable.
+            [[nodiscard]] byte stored(regi index) const noexcept
+            {
+                switch (encoding_)
+                {
+                    case Encoding::NIBBLE: return (words_[index >> 4] >> ((index & 15) * 4)) & 15;
+                    case Encoding::MOD3:   return (words_[index >> 5] >> ((index & 31) * 2)) & 3;
+                    case Encoding::BIT:    return (words_[index >> 6] >> (index & 63)) & 1;
+                    default:               return 0;
+                }
+            }
+
+            // Starts loading the word holding index into cache without waiting for it.
+            void prefetch(regi index) const noexcept
+            {
+                switch (encoding_)
+                {
+                    case Encoding::NIBBLE: __builtin_prefetch(&words_[index >> 4]); break;
+                    case Encoding::MOD3:   __builtin_prefetch(&words_[index >> 5]); break;
+                    case Encoding::BIT:    __builtin_prefetch(&words_[index >> 6]); break;
+                    default: break;
+                }
+            }
+
+            [[nodiscard]] const std::uint64_t* data() const noexcept;
+        };
+
+        struct TableConfig
+        {
+            regi memoryBudget = regi(256) << 20;
+            bool optimal      = false;
+        };
+
+        struct TablePlan
+        {
+            std::array<Encoding, numTables> encoding{};
+            regi bytes   = 0;
+            regi scratch = 0;
+        };
+
+        [[nodiscard]] regi entries(TableId id) noexcept;
+
+        // Chooses per-table encodings in priority order (phase tables first, then the optimal-search
+        // corner table): MOD3 where it fits, else BIT, then upgrades to NIBBLE while budget remains.
+        // Building a table takes a byte per entry of scratch on top of the tables already built, so
+        // the largest such buffer counts against the budget too.
+        [[nodiscard]] TablePlan plan(const TableConfig& config) noexcept;
+
+        // Selects the tables used from now on. Tables are built on first use; a table that is no
+        // longer planned is freed once the last heuristic using it is gone.
+        void configure(const TableConfig& config);
+        [[nodiscard]] TableConfig currentConfig();
+        [[nodiscard]] TablePlan currentPlan();
+
+        // Builds every planned table now. Deadline-bounded searches never build a table themselves.
+        void prepare();
+
+        [[nodiscard]] std::shared_ptr<const PruningTable> table(TableId id);
+
+        // The table if it has already been built, without building it.
+        [[nodiscard]] std::shared_ptr<const PruningTable> built(TableId id);
+        [[nodiscard]] regi index(TableId id, const CubieState& state) noexcept;
+
+        // Exact distance of state from the table's goal, or unreachable.
+        [[nodiscard]] byte distance(TableId id, const CubieState& state);
+
+        class Heuristic
+        {
+        private:
+            TableId id_;
+            std::shared_ptr<const PruningTable> owner_;
+            const PruningTable* table_;
+
+        public:
+            Heuristic(TableId id, std::shared_ptr<const PruningTable> table) noexcept;
+
+            [[nodiscard]] byte initial(const CubieState& state) const;
+
+            [[nodiscard]] byte next(const CubieState& state, byte parent) const noexcept
+            {
+                return table_ ? lookup(index(id_, state), parent) : 0;
+            }
+
+            // next() split in two for pipelined expansion: locate() computes the entry and prefetches
+            // it, lookup() decodes it once every sibling has been located.
+            [[nodiscard]] regi locate(const CubieState& state) const noexcept
+            {
+                if (!table_) {return 0;}
+
+                regi i = index(id_, state);
+
+                table_->prefetch(i);
+
+                return i;
+            }
+
+            [[nodiscard]] byte lookup(regi entry, byte parent) const noexcept
+            {
+                if (!table_) {return 0;}
+
+                byte v = table_->stored(entry);
+
+                switch (table_->encoding())
+                {
+                    case Encoding::NIBBLE: return v == 15 ? unreachable : v;
+                    case Encoding::BIT:    return v ? table_->bound() : 0;
+                    case Encoding::MOD3:
+                    {
+                        if (v == 3) {return unreachable;}
+
+                        byte low = parent ? parent - 1 : 0;
+
+                        for (byte d = low; d <= parent + 1; ++d)
+                        {
+                            if (d % 3 == v) {return d;}
+                        }
+
+                        return 0;
+                    }
+                    default: return 0;
+                }
+            }
+        };
+
+        [[nodiscard]] Heuristic heuristic(TableId id);
+
+        // As above, but with a bounded deadline a table that hasn't been built is left alone and the
+        // heuristic is empty: building one takes far longer than a typical budget.
+        [[nodiscard]] Heuristic heuristic(TableId id, const Deadline& deadline);
+        [[nodiscard]] TableId phaseTable(byte phase) noexcept;
+    }
+}
@@ -0,0 +1,100 @@
+#include "Race.hpp"
+#include <condition_variable>
+
+namespace slvr
+{
+    namespace race
+    {
+        static bool better(const thistlethwaite::SolveResult& a, const thistlethwaite::SolveResult& b) noexcept
+        {
+            if (a.solved != b.solved) {return a.solved;}
+            if (!a.solved) {return static_cast<byte>(a.reached) > static_cast<byte>(b.reached);}
+
+            return a.solution.size() < b.solution.size();
+        }
+
+        RaceResult solve(const Cube& cube, const SearchLimits& limits, Policy policy)
+        {
+            const Cube inv = sym::inverse(cube);
+
+            SearchLimits inner;
+            inner.deadline = limits.deadline;
+
+            thistlethwaite::SolveOptions options;
+            options.parallel = false;
+            options.improve = policy == Policy::SHORTEST;
+
+            std::array<RaceResult, numVariants> results;
+            std::array<sym::Canonical, numVariants> frames;
+            std::array<std::thread, numVariants> threads;
+            std::mutex mtx;
+            std::condition_variable finished;
+            byte done = 0;
+
+            for (byte i = 0; i < numVariants; ++i)
+            {
+                byte s = sym::axisRotation(i / 2);
+                bool inverted = i % 2;
+                Cube input = sym::conjugate(inverted ? inv : cube, s);
+
+                frames[i] = sym::Canonical{pack(input), s, inverted};
+
+                threads[i] = std::thread([&, i, input = std::move(input)]
+                {
+                    thistlethwaite::SolveResult result = thistlethwaite::solve(input, inner, options);
+
+                    std::lock_guard<std::mutex> lock(mtx);
+
+                    results[i].result = std::move(result);
+                    ++done;
+
+                    if (results[i].result.solved && (policy == Policy::FIRST || results[i].result.optimal))
+                    {
+                        inner.token.cancel();
+                    }
+
+                    finished.notify_one();
+                });
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+
+                while (done < numVariants)
+                {
+                    finished.wait_for(lock, std::chrono::milliseconds(1));
+
+                    if (limits.token.cancelled()) {inner.token.cancel();}
+                }
+            }
+
+            for (auto& t : threads) {t.join();}
+
+            byte best = 0;
+
+            for (byte i = 1; i < numVariants; ++i)
+            {
+                if (better(results[i].result, results[best].result)) {best = i;}
+            }
+
+            RaceResult winner = std::move(results[best]);
+
+            winner.symmetry = frames[best].symmetry;
+            winner.inverted = frames[best].inverted;
+
+            if (winner.result.solved)
+            {
+                winner.result.solution = sym::fromCanonical(winner.result.solution, frames[best]);
+                winner.result.timedOut = limits.deadline.expired();
+            }
+            else if (winner.inverted || winner.symmetry != sym::identity)
+            {
+                winner = std::move(results[0]);
+                winner.symmetry = sym::identity;
+                winner.inverted = false;
+            }
+
+            return winner;
+        }
+    }
+}
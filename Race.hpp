@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Solver.hpp"
+#include "Symmetry.hpp"
+
+namespace slvr
+{
+    // Solves the three diagonal-axis orientations of the cube and of its inverse in parallel and
+    // maps the winning solution back into the caller's frame.
+    namespace race
+    {
+        enum class Policy : byte
+        {
+            FIRST,   // stop at the first complete solution
+            SHORTEST // keep improving until the deadline and take the shortest
+        };
+
+        constexpr const byte numVariants = 6;
+
+        struct RaceResult
+        {
+            thistlethwaite::SolveResult result;
+            byte symmetry = sym::identity;
+            bool inverted = false;
+        };
+
+        // As with thistlethwaite::solve, prepare the tables first when the deadline is bounded.
+        [[nodiscard]] RaceResult solve(const Cube& cube, const SearchLimits& limits = {}, Policy policy = Policy::FIRST);
+    }
+}
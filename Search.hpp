@@ -0,0 +1,488 @@
+#pragma once
+
+#include "Cube.hpp"
+#include "SearchControl.hpp"
+#include "Generator.hpp"
+#include <algorithm>
+#include <concepts>
+#include <utility>
+#include <vector>
+
+namespace slvr
+{
+    // Bare cubie state used by the search kernels: no solution history, trivially copyable.
+    struct CubieState
+    {
+        corner_arr cp{0,1,2,3,4,5,6,7};
+        corner_arr co{};
+        edge_arr   ep{0,1,2,3,4,5,6,7,8,9,10,11};
+        edge_arr   eo{};
+
+        CubieState() noexcept = default;
+        explicit CubieState(const Cube& cube) noexcept :
+            cp(cube.cornerPositions()), co(cube.cornerOrientations()), ep(cube.edgePositions()), eo(cube.edgeOrientations())
+        {}
+
+        [[nodiscard]] const corner_arr& cornerPositions()    const noexcept {return cp;}
+        [[nodiscard]] const corner_arr& cornerOrientations() const noexcept {return co;}
+        [[nodiscard]] const edge_arr&   edgePositions()      const noexcept {return ep;}
+        [[nodiscard]] const edge_arr&   edgeOrientations()   const noexcept {return eo;}
+
+        [[nodiscard]] bool isSolved() const noexcept {return *this == CubieState();}
+
+        [[nodiscard]] bool operator==(const CubieState& other) const noexcept = default;
+    };
+
+    namespace search
+    {
+        // Clockwise quarter turn of one face: the pieces at cycle[0..3] move one step along the cycle,
+        // then the piece arriving at cycle[i] is twisted by twist[i] and flipped if flip is set.
+        struct FaceTurn
+        {
+            std::array<byte, 4> corners;
+            std::array<byte, 4> edges;
+            std::array<byte, 4> twist;
+            bool flip;
+        };
+
+        constexpr const std::array<FaceTurn, 6> faceTurns {{{{0, 4, 5, 1}, {1, 4,  9, 5}, {2, 1, 2, 1}, false},  // R
+                                                            {{2, 6, 7, 3}, {3, 6, 11, 7}, {2, 1, 2, 1}, false},  // L
+                                                            {{0, 1, 2, 3}, {0, 1,  2, 3}, {0, 0, 0, 0}, false},  // U
+                                                            {{4, 7, 6, 5}, {8, 11, 10, 9}, {0, 0, 0, 0}, false}, // D
+                                                            {{1, 5, 6, 2}, {2, 5, 10, 6}, {2, 1, 2, 1}, true },  // F
+                                                            {{0, 3, 7, 4}, {0, 7,  8, 4}, {1, 2, 1, 2}, true }}};// B
+
+        // state'[p] = state[src[p]], orientation'[p] = orientation[src[p]] + delta[p]
+        struct MoveDef
+        {
+            corner_arr cornerSrc;
+            corner_arr twist;
+            edge_arr   edgeSrc;
+            edge_arr   flip;
+        };
+
+        [[nodiscard]] constexpr MoveDef identityDef() noexcept
+        {
+            return MoveDef{{0,1,2,3,4,5,6,7}, {}, {0,1,2,3,4,5,6,7,8,9,10,11}, {}};
+        }
+
+        [[nodiscard]] constexpr MoveDef quarterDef(const FaceTurn& turn) noexcept
+        {
+            MoveDef def = identityDef();
+
+            for (byte i = 0; i < 4; ++i)
+            {
+                byte to = turn.corners[(i + 1) % 4], edgeTo = turn.edges[(i + 1) % 4];
+
+                def.cornerSrc[to] = turn.corners[i];
+                def.edgeSrc[edgeTo] = turn.edges[i];
+            }
+
+            for (byte i = 0; i < 4; ++i)
+            {
+                def.twist[turn.corners[i]] = turn.twist[i];
+                def.flip[turn.edges[i]] = turn.flip;
+            }
+
+            return def;
+        }
+
+        [[nodiscard]] constexpr MoveDef compose(const MoveDef& first, const MoveDef& second) noexcept
+        {
+            MoveDef def;
+
+            for (byte p = 0; p < 8; ++p)
+            {
+                def.cornerSrc[p] = first.cornerSrc[second.cornerSrc[p]];
+                def.twist[p] = (first.twist[second.cornerSrc[p]] + second.twist[p]) % 3;
+            }
+
+            for (byte p = 0; p < 12; ++p)
+            {
+                def.edgeSrc[p] = first.edgeSrc[second.edgeSrc[p]];
+                def.flip[p] = first.flip[second.edgeSrc[p]] ^ second.flip[p];
+            }
+
+            return def;
+        }
+
+        [[nodiscard]] constexpr std::array<MoveDef, 18> buildMoveDefs() noexcept
+        {
+            std::array<MoveDef, 18> defs{};
+
+            for (byte f = 0; f < 6; ++f)
+            {
+                MoveDef quarter = quarterDef(faceTurns[f]);
+                MoveDef half = compose(quarter, quarter);
+
+                defs[3 * f]     = quarter;
+                defs[3 * f + 1] = compose(half, quarter);
+                defs[3 * f + 2] = half;
+            }
+
+            return defs;
+        }
+
+        constexpr const std::array<MoveDef, 18> moveDefs = buildMoveDefs();
+
+        template <Move M>
+        inline void apply(CubieState& s) noexcept
+        {
+            constexpr const MoveDef& def = moveDefs[static_cast<byte>(M)];
+
+            const CubieState old = s;
+
+            for (byte p = 0; p < 8; ++p)
+            {
+                s.cp[p] = old.cp[def.cornerSrc[p]];
+                s.co[p] = static_cast<byte>((old.co[def.cornerSrc[p]] + def.twist[p]) % 3);
+            }
+
+            for (byte p = 0; p < 12; ++p)
+            {
+                s.ep[p] = old.ep[def.edgeSrc[p]];
+                s.eo[p] = old.eo[def.edgeSrc[p]] ^ def.flip[p];
+            }
+        }
+
+        template <const auto& Moves, regi... I>
+        inline void applyAt(CubieState& s, byte i, std::index_sequence<I...>) noexcept
+        {
+            static_cast<void>(((i == I ? (apply<Moves[I]>(s), true) : false) || ...));
+        }
+
+        // Applies Moves[i] through a dispatch the compiler can turn into a jump table of inlined moves.
+        template <const auto& Moves>
+        inline void applyAt(CubieState& s, byte i) noexcept
+        {
+            applyAt<Moves>(s, i, std::make_index_sequence<std::tuple_size_v<std::decay_t<decltype(Moves)>>>{});
+        }
+
+        constexpr const std::array<Move, 18> allMoves {Move::R, Move::R_PRIME, Move::R2,
+                                                       Move::L, Move::L_PRIME, Move::L2,
+                                                       Move::U, Move::U_PRIME, Move::U2,
+                                                       Move::D, Move::D_PRIME, Move::D2,
+                                                       Move::F, Move::F_PRIME, Move::F2,
+                                                       Move::B, Move::B_PRIME, Move::B2};
+
+        inline void apply(CubieState& s, Move move) noexcept
+        {
+            if (move != Move::NULL_MOVE) {applyAt<allMoves>(s, static_cast<byte>(move));}
+        }
+
+        // A heuristic gives a lower bound on the remaining depth. next() also receives the parent's
+        // bound so that tables storing only distance mod 3 can recover the exact value incrementally.
+        struct NoHeuristic
+        {
+            [[nodiscard]] constexpr byte initial(const CubieState&) const noexcept {return 0;}
+            [[nodiscard]] constexpr byte next(const CubieState&, byte) const noexcept {return 0;}
+        };
+
+        constexpr const regi maxSearchDepth = 32;
+
+        // Same-face and commuting opposite-face pruning, as in Cube::pruneMove.
+        [[nodiscard]] constexpr bool redundant(byte face, byte last, byte secondLast) noexcept
+        {
+            return face == last || (face == (last ^ 1) && face == secondLast);
+        }
+
+        // Stricter than redundant(): commuting opposite faces are only taken in ascending order, so
+        // each equivalence class of move sequences under that commutation is visited once.
+        [[nodiscard]] constexpr bool nonCanonical(byte face, byte last, byte secondLast) noexcept
+        {
+            return redundant(face, last, secondLast) || (face == (last ^ 1) && face < last);
+        }
+
+        // Heuristics whose lookup can be split into locating the table entry (and prefetching it) and
+        // decoding it later, see pruning::Heuristic.
+        template <class Heuristic>
+        concept Prefetching = requires(const Heuristic& h, const CubieState& s, regi entry, byte parent)
+        {
+            {h.locate(s)} -> std::convertible_to<regi>;
+            {h.lookup(entry, parent)} -> std::convertible_to<byte>;
+        };
+
+        // What a search policy makes of a generated child, see Kernel.
+        enum class Visit : byte
+        {
+            EXPAND,  // not a goal: search below it while the bounds allow
+            REPORT,  // hand it to the caller and don't search below it
+            CUT      // neither
+        };
+
+        enum class Event : byte
+        {
+            GOAL,       // a reported child, see Kernel::length() and Kernel::moves()
+            EXHAUSTED,  // nothing within the bounds is left to expand
+            STOPPED     // the search context asked to stop
+        };
+
+        // Behaviour of a plain move-count search, which other policies derive from and override:
+        //   pruned(face, last, secondLast)  skips a move given the faces of the two before it
+        //   step(previous, move)            cost of move after previous (the move into start first)
+        //   visit(child, length, g)         goal handling for a child length moves and g cost deep
+        //   admit(length, g, h)             bounds on top of length + h <= maxDepth, checked before a
+        //                                   child is queued for expansion
+        //   poll(kernel)                    called before each child is visited
+        template <class Goal>
+        struct CountPolicy
+        {
+            const Goal& goal;
+
+            [[nodiscard]] constexpr bool pruned(byte face, byte last, byte secondLast) const noexcept {return redundant(face, last, secondLast);}
+            [[nodiscard]] constexpr std::uint32_t step(byte, Move) const noexcept {return 1;}
+            [[nodiscard]] Visit visit(const CubieState& child, regi, std::uint32_t) const {return goal(child) ? Visit::REPORT : Visit::EXPAND;}
+            [[nodiscard]] constexpr bool admit(regi, std::uint32_t, byte) const noexcept {return true;}
+
+            template <class Kernel>
+            constexpr void poll(Kernel&) const noexcept {}
+        };
+
+        // The depth-first engine under every search: an explicit stack of frames, child generation,
+        // move pruning and heuristic evaluation, with the policy deciding the rest. A node is expanded
+        // in one go: every child state is generated and its table entry located and prefetched first,
+        // and only then are the entries read, so the cache misses of all siblings overlap instead of
+        // being paid one after another. Reported children are visited first, then the rest in order
+        // of increasing bound. next() runs to the next reported child and can be called again to
+        // carry on from there.
+        template <const auto& Moves, class Policy, class Heuristic = NoHeuristic>
+        class Kernel
+        {
+        public:
+            static constexpr byte n = static_cast<byte>(std::tuple_size_v<std::decay_t<decltype(Moves)>>);
+
+            // The children of the node at one depth.
+            struct Frame
+            {
+                std::array<CubieState, n> children;
+                std::array<byte, n> order;  // move indices of the children still to visit, reported first
+                std::array<byte, n> h;      // by move index
+                std::uint32_t g;            // cost of the node
+                byte count;
+                byte reports;
+                byte next;
+                byte last;                  // faces of the two moves into the node
+                byte secondLast;
+                byte previous;              // the move into the node
+            };
+
+        private:
+            Policy& policy_;
+            const Heuristic& heuristic_;
+            SearchContext& ctx_;
+            std::vector<Frame> stack_;
+            std::array<Move, maxSearchDepth> moves_;
+            regi maxDepth_;
+            regi depth_;
+            regi length_;
+            std::uint32_t cost_;
+
+            void expand(const CubieState& state, regi depth, byte h, byte last, byte secondLast, byte previous, std::uint32_t g)
+            {
+                Frame& frame = stack_[depth];
+                std::array<byte, n> candidates;
+                std::array<std::uint32_t, n> costs;
+                [[maybe_unused]] std::array<regi, n> entries;
+                byte numCandidates = 0;
+                const regi length = depth + 1;
+                const bool leaf = length == maxDepth_;
+
+                frame.g = g;
+                frame.count = 0;
+                frame.reports = 0;
+                frame.next = 0;
+                frame.last = last;
+                frame.secondLast = secondLast;
+                frame.previous = previous;
+
+                for (byte i = 0; i < n; ++i)
+                {
+                    if (policy_.pruned(static_cast<byte>(Moves[i]) / 3, last, secondLast)) {continue;}
+
+                    CubieState& child = frame.children[i];
+
+                    child = state;
+                    applyAt<Moves>(child, i);
+                    costs[i] = g + policy_.step(previous, Moves[i]);
+
+                    Visit visit = policy_.visit(child, length, costs[i]);
+
+                    if (visit == Visit::REPORT) {frame.order[frame.reports++] = i; continue;}
+                    if (visit == Visit::CUT || leaf) {continue;}
+
+                    if constexpr (Prefetching<Heuristic>) {entries[i] = heuristic_.locate(child);}
+
+                    candidates[numCandidates++] = i;
+                }
+
+                frame.count = frame.reports;
+
+                for (byte c = 0; c < numCandidates; ++c)
+                {
+                    byte i = candidates[c];
+                    byte childH;
+
+                    if constexpr (Prefetching<Heuristic>) {childH = heuristic_.lookup(entries[i], h);}
+                    else {childH = heuristic_.next(frame.children[i], h);}
+
+                    if (length + childH > maxDepth_ || !policy_.admit(length, costs[i], childH)) {continue;}
+
+                    frame.h[i] = childH;
+
+                    // Insertion keeps equal bounds in move order.
+                    byte at = frame.count++;
+
+                    for (; at > frame.reports && frame.h[frame.order[at - 1]] > childH; --at) {frame.order[at] = frame.order[at - 1];}
+
+                    frame.order[at] = i;
+                }
+            }
+
+        public:
+            // last and secondLast are the faces of the moves that led to start (Face::NULL_FACE if
+            // none), previous the move itself. start is not checked against the goal, and no path
+            // may be longer than maxDepth.
+            Kernel(const CubieState& start, byte h, Face last, Face secondLast, regi maxDepth, Policy& policy,
+                   const Heuristic& heuristic, SearchContext& ctx, byte previous = static_cast<byte>(Move::NULL_MOVE)) :
+                policy_(policy),
+                heuristic_(heuristic),
+                ctx_(ctx),
+                stack_(std::max<regi>(std::min(maxDepth, maxSearchDepth), 1)),
+                maxDepth_(std::min(maxDepth, maxSearchDepth)),
+                depth_(0),
+                length_(0),
+                cost_(0)
+            {
+                if (maxDepth_ == 0) {stack_[0].count = stack_[0].next = 0; return;}
+
+                expand(start, 0, h, static_cast<byte>(last), static_cast<byte>(secondLast), previous, 0);
+            }
+
+            Event next()
+            {
+                while (true)
+                {
+                    Frame& frame = stack_[depth_];
+
+                    if (frame.next == frame.count)
+                    {
+                        if (depth_ == 0) {return Event::EXHAUSTED;}
+
+                        --depth_;
+                        continue;
+                    }
+
+                    policy_.poll(*this);
+
+                    if (frame.next == frame.count) {continue;}
+                    if (ctx_.stopped()) {return Event::STOPPED;}
+
+                    bool report = frame.next < frame.reports;
+                    byte i = frame.order[frame.next++];
+                    std::uint32_t g = frame.g + policy_.step(frame.previous, Moves[i]);
+
+                    moves_[depth_] = Moves[i];
+
+                    if (report) {length_ = depth_ + 1; cost_ = g; return Event::GOAL;}
+
+                    expand(frame.children[i], depth_ + 1, frame.h[i], static_cast<byte>(Moves[i]) / 3, frame.last, static_cast<byte>(Moves[i]), g);
+                    ++depth_;
+                }
+            }
+
+            // Moves from start to the last reported child, and its length and cost.
+            [[nodiscard]] const std::array<Move, maxSearchDepth>& moves() const noexcept {return moves_;}
+            [[nodiscard]] regi length() const noexcept {return length_;}
+            [[nodiscard]] std::uint32_t cost() const noexcept {return cost_;}
+
+            // The open frames, for policies that hand untried children to other workers. moves()
+            // holds the path to the node of every frame below depth().
+            [[nodiscard]] regi depth() const noexcept {return depth_;}
+            [[nodiscard]] Frame& frame(regi depth) noexcept {return stack_[depth];}
+        };
+
+        // Depth-limited search from start. last and secondLast are the faces of the moves that led to
+        // start (Face::NULL_FACE if none). On success path holds the moves found, which are no more
+        // than maxDepth but not necessarily the fewest.
+        template <const auto& Moves, class Goal, class Heuristic = NoHeuristic>
+        bool run(const CubieState& start, regi maxDepth, Face last, Face secondLast, std::vector<Move>& path,
+                 SearchContext& ctx, const Goal& goal, const Heuristic& heuristic = {})
+        {
+            path.clear();
+
+            if (goal(start)) {return true;}
+            if (maxDepth == 0) {return false;}
+
+            byte h = heuristic.initial(start);
+
+            if (h > maxDepth) {return false;}
+
+            CountPolicy<Goal> policy{goal};
+            Kernel<Moves, CountPolicy<Goal>, Heuristic> kernel(start, h, last, secondLast, maxDepth, policy, heuristic, ctx);
+
+            if (kernel.next() != Event::GOAL) {return false;}
+
+            path.assign(kernel.moves().begin(), kernel.moves().begin() + kernel.length());
+
+            return true;
+        }
+
+        // Reports goals at one exact length only and passes through those on the way, taking
+        // commuting opposite faces in one order.
+        template <class Goal>
+        struct LengthPolicy : CountPolicy<Goal>
+        {
+            regi length;
+
+            [[nodiscard]] constexpr bool pruned(byte face, byte last, byte secondLast) const noexcept {return nonCanonical(face, last, secondLast);}
+
+            [[nodiscard]] Visit visit(const CubieState& child, regi depth, std::uint32_t) const
+            {
+                if (depth < length) {return Visit::EXPAND;}
+
+                return this->goal(child) ? Visit::REPORT : Visit::CUT;
+            }
+        };
+
+        // Lazily yields every canonical move sequence of length <= maxLength that takes start to a goal
+        // state, shortest first. Each length is a separate pass of the kernel held in the coroutine
+        // frame, so memory depends on maxLength only; the pass pauses at each yield until the consumer
+        // pulls again. Sequences that pass through a goal on the way are included. The yielded path is
+        // overwritten on the next pull, so copy it to keep it.
+        template <const auto& Moves, class Goal, class Heuristic = NoHeuristic>
+        Generator<std::vector<Move>> enumerate(CubieState start, regi maxLength, Face last, Face secondLast,
+                                               SearchLimits limits, Goal goal, Heuristic heuristic = {})
+        {
+            std::atomic<bool> solutionFound(false);
+            SearchContext ctx(solutionFound, limits);
+            std::vector<Move> path;
+
+            if (maxLength > maxSearchDepth) {maxLength = maxSearchDepth;}
+
+            path.reserve(maxLength);
+
+            if (goal(start)) {co_yield path;}
+
+            byte h = heuristic.initial(start);
+
+            if (h > maxLength) {co_return;}
+
+            for (regi length = std::max<regi>(h, 1); length <= maxLength; ++length)
+            {
+                LengthPolicy<Goal> policy{{goal}, length};
+                Kernel<Moves, LengthPolicy<Goal>, Heuristic> kernel(start, h, last, secondLast, length, policy, heuristic, ctx);
+
+                while (true)
+                {
+                    Event event = kernel.next();
+
+                    if (event == Event::STOPPED) {co_return;}
+                    if (event == Event::EXHAUSTED) {break;}
+
+                    path.assign(kernel.moves().begin(), kernel.moves().begin() + kernel.length());
+                    co_yield path;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#include "SearchControl.hpp"
+
+namespace slvr
+{
+    CancellationToken::CancellationToken() :
+        flag_(std::make_shared<std::atomic<bool>>(false))
+    {}
+
+    void CancellationToken::cancel() noexcept {flag_->store(true, std::memory_order_relaxed);}
+
+    bool CancellationToken::cancelled() const noexcept {return flag_->load(std::memory_order_relaxed);}
+
+    const std::atomic<bool>& CancellationToken::flag() const noexcept {return *flag_;}
+
+    Deadline::Deadline() noexcept : at_(Clock::time_point::max()) {}
+
+    Deadline::Deadline(Clock::time_point at) noexcept : at_(at) {}
+
+    Deadline Deadline::never() noexcept {return Deadline();}
+
+    Deadline Deadline::after(Clock::duration budget) noexcept
+    {
+        Clock::time_point now = Clock::now();
+
+        if (budget >= Clock::time_point::max() - now) {return Deadline();}
+
+        return Deadline(now + budget);
+    }
+
+    Clock::time_point Deadline::time() const noexcept {return at_;}
+
+    Clock::duration Deadline::remaining() const noexcept
+    {
+        if (unbounded()) {return Clock::duration::max();}
+
+        Clock::time_point now = Clock::now();
+
+        if (now >= at_) {return Clock::duration::zero();}
+
+        return at_ - now;
+    }
+
+    bool Deadline::unbounded() const noexcept {return at_ == Clock::time_point::max();}
+
+    bool Deadline::expired() const noexcept
+    {
+        if (unbounded()) {return false;}
+
+        return Clock::now() >= at_;
+    }
+
+    bool SearchLimits::reached() const noexcept
+    {
+        return token.cancelled() || deadline.expired();
+    }
+
+    SearchContext::SearchContext(const std::atomic<bool>& solutionFound, const SearchLimits& limits) noexcept :
+        solutionFound_(solutionFound),
+        cancelled_(limits.token.flag()),
+        deadline_(limits.deadline),
+        polls_(0),
+        expired_(false)
+    {}
+
+    bool SearchContext::stopped() noexcept
+    {
+        if (solutionFound_.load(std::memory_order_relaxed)) {return true;}
+        if (cancelled_.load(std::memory_order_relaxed))     {return true;}
+        if (expired_) {return true;}
+
+        if (++polls_ % pollInterval == 0 && deadline_.expired()) {expired_ = true;}
+
+        return expired_;
+    }
+
+    bool SearchContext::interrupted() const noexcept
+    {
+        return expired_ || cancelled_.load(std::memory_order_relaxed);
+    }
+
+    regi SearchContext::polls() const noexcept {return polls_;}
+    const Deadline& SearchContext::deadline() const noexcept {return deadline_;}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Cube.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace slvr
+{
+    using Clock = std::chrono::steady_clock;
+
+    class CancellationToken
+    {
+    private:
+        std::shared_ptr<std::atomic<bool>> flag_;
+
+    public:
+        CancellationToken();
+
+        void cancel() noexcept;
+
+        [[nodiscard]] bool cancelled() const noexcept;
+        [[nodiscard]] const std::atomic<bool>& flag() const noexcept;
+    };
+
+    class Deadline
+    {
+    private:
+        Clock::time_point at_;
+
+    public:
+        Deadline() noexcept;
+        explicit Deadline(Clock::time_point at) noexcept;
+
+        [[nodiscard]] static Deadline never() noexcept;
+        [[nodiscard]] static Deadline after(Clock::duration budget) noexcept;
+
+        [[nodiscard]] Clock::time_point time()      const noexcept;
+        [[nodiscard]] Clock::duration   remaining() const noexcept;
+        [[nodiscard]] bool              unbounded() const noexcept;
+        [[nodiscard]] bool              expired()   const noexcept;
+    };
+
+    struct SearchLimits
+    {
+        Deadline deadline;
+        CancellationToken token;
+
+        [[nodiscard]] bool reached() const noexcept;
+    };
+
+    // Per-thread view of a search's stop conditions. The shared flag and the token are
+    // read on every poll; the clock is only read every pollInterval polls.
+    class SearchContext
+    {
+    private:
+        static constexpr regi pollInterval = 256;
+
+        const std::atomic<bool>& solutionFound_;
+        const std::atomic<bool>& cancelled_;
+        Deadline deadline_;
+        regi polls_;
+        bool expired_;
+
+    public:
+        SearchContext(const std::atomic<bool>& solutionFound, const SearchLimits& limits) noexcept;
+
+        [[nodiscard]] bool stopped() noexcept;
+        [[nodiscard]] bool interrupted() const noexcept;
+        [[nodiscard]] regi polls() const noexcept;
+        [[nodiscard]] const Deadline& deadline() const noexcept;
+    };
+}
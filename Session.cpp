@@ -0,0 +1,135 @@
+#include "Session.hpp"
+#include "Simplify.hpp"
+#include "Symmetry.hpp"
+#include <limits>
+
+namespace slvr
+{
+    SolveSession::SolveSession(const Cube& cube, SessionConfig config) :
+        config_(std::move(config)),
+        state_(cube),
+        version_(0),
+        solvedVersion_(std::numeric_limits<regi>::max()),
+        stopping_(false)
+    {
+        current_.store(std::make_shared<const Snapshot>(Snapshot{{}, 0, false}));
+        worker_ = std::thread([this] {work();});
+    }
+
+    SolveSession::~SolveSession()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            stopping_ = true;
+        }
+
+        changed_.notify_all();
+
+        if (worker_.joinable()) {worker_.join();}
+    }
+
+    void SolveSession::apply(Move move)
+    {
+        if (move == Move::NULL_MOVE) {return;}
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+
+            std::shared_ptr<const Snapshot> current = current_.load();
+            std::vector<Move> next;
+
+            search::apply(state_, move);
+            history_.push_back(move);
+
+            if (current->solved)
+            {
+                next.reserve(current->solution.size() + 1);
+                next.push_back(sym::inverse(move));
+                next.insert(next.end(), current->solution.begin(), current->solution.end());
+                next = simplify::merge(next);
+            }
+
+            current_.store(std::make_shared<const Snapshot>(Snapshot{std::move(next), ++version_, current->solved}));
+        }
+
+        changed_.notify_one();
+    }
+
+    void SolveSession::work()
+    {
+        pruning::prepare();
+        simplify::prepare();
+
+        std::unique_lock<std::mutex> lock(mtx_);
+
+        while (true)
+        {
+            settled_.notify_all();
+            changed_.wait(lock, [this] {return stopping_ || version_ != solvedVersion_;});
+
+            if (stopping_) {return;}
+
+            const CubieState state = state_;
+            const regi version = version_;
+
+            history_.clear();
+            lock.unlock();
+
+            // Until there is a solution at all, search without a deadline.
+            SearchLimits limits;
+
+            if (current_.load()->solved) {limits.deadline = Deadline::after(config_.budget);}
+
+            thistlethwaite::SolveResult result = thistlethwaite::solve(Cube(state.cp, state.co, state.ep, state.eo), limits, config_.options);
+
+            lock.lock();
+            solvedVersion_ = version;
+
+            if (!result.solved) {continue;}
+
+            // Replay the moves made during the search, newest inverse first.
+            std::vector<Move> candidate;
+
+            candidate.reserve(history_.size() + result.solution.size());
+
+            for (regi i = history_.size(); i-- > 0;) {candidate.push_back(sym::inverse(history_[i]));}
+
+            candidate.insert(candidate.end(), result.solution.begin(), result.solution.end());
+            candidate = simplify::merge(candidate);
+
+            std::shared_ptr<const Snapshot> current = current_.load();
+
+            if (!current->solved || candidate.size() < current->solution.size())
+            {
+                current_.store(std::make_shared<const Snapshot>(Snapshot{std::move(candidate), version_, true}));
+            }
+        }
+    }
+
+    std::shared_ptr<const SolveSession::Snapshot> SolveSession::solution() const noexcept
+    {
+        return current_.load();
+    }
+
+    regi SolveSession::version() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        return version_;
+    }
+
+    CubieState SolveSession::state() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        return state_;
+    }
+
+    void SolveSession::wait()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+
+        settled_.wait(lock, [this] {return stopping_ || version_ == solvedVersion_;});
+    }
+}
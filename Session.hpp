@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Solver.hpp"
+#include <condition_variable>
+#include <memory>
+
+namespace slvr
+{
+    struct SessionConfig
+    {
+        thistlethwaite::SolveOptions options{false, false, true, 1};
+        Clock::duration budget = std::chrono::milliseconds(50);  // per background re-solve
+    };
+
+    // Keeps a solution for a cube that is being turned one move at a time. An update prefixes the
+    // inverse of the move to the current solution, so it stays valid at once; a background thread
+    // then re-solves the new state with the phase searches and swaps the result in if it is
+    // shorter. Moves applied while it runs are replayed onto its result first. The first solve also
+    // runs on that thread, after it has built the tables, so construction never blocks; until it
+    // finishes the snapshot is unsolved.
+    class SolveSession
+    {
+    public:
+        struct Snapshot
+        {
+            std::vector<Move> solution;
+            regi version;
+            bool solved;
+        };
+
+    private:
+        SessionConfig config_;
+
+        mutable std::mutex mtx_;
+        std::condition_variable changed_;
+        std::condition_variable settled_;
+        CubieState state_;
+        regi version_;
+        regi solvedVersion_;         // last version the background thread has re-solved
+        std::vector<Move> history_;  // moves applied since its current snapshot
+        bool stopping_;
+
+        std::atomic<std::shared_ptr<const Snapshot>> current_;
+        std::thread worker_;
+
+        void work();
+
+    public:
+        explicit SolveSession(const Cube& cube, SessionConfig config = {});
+        SolveSession(const SolveSession&) = delete;
+        SolveSession& operator=(const SolveSession&) = delete;
+        ~SolveSession();
+
+        // Records a move the user made. Doesn't wait for any search. NULL_MOVE is ignored.
+        void apply(Move move);
+
+        // Current solution; never blocks and stays valid after later updates.
+        [[nodiscard]] std::shared_ptr<const Snapshot> solution() const noexcept;
+
+        [[nodiscard]] regi version() const;
+        [[nodiscard]] CubieState state() const;
+
+        // Blocks until the background re-solve has caught up with every update.
+        void wait();
+    };
+}
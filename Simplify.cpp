@@ -0,0 +1,349 @@
+#include "Simplify.hpp"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+namespace slvr
+{
+    namespace simplify
+    {
+        static byte amount(Move move) noexcept
+        {
+            switch (static_cast<byte>(move) % 3)
+            {
+                case 0:  return 1;
+                case 1:  return 3;
+                default: return 2;
+            }
+        }
+
+        static Move turn(byte face, byte quarters) noexcept
+        {
+            return static_cast<Move>(face * 3 + (quarters == 1 ? 0 : quarters == 3 ? 1 : 2));
+        }
+
+        static void append(std::vector<Move>& out, Move move)
+        {
+            byte face = static_cast<byte>(move) / 3;
+            regi n = out.size();
+
+            if (n >= 1 && static_cast<byte>(out[n - 1]) / 3 == face)
+            {
+                byte quarters = (amount(out[n - 1]) + amount(move)) % 4;
+
+                out.pop_back();
+
+                if (quarters) {out.push_back(turn(face, quarters));}
+
+                return;
+            }
+
+            if (n >= 2 && static_cast<byte>(out[n - 1]) / 3 == (face ^ 1) && static_cast<byte>(out[n - 2]) / 3 == face)
+            {
+                byte quarters = (amount(out[n - 2]) + amount(move)) % 4;
+
+                if (quarters)
+                {
+                    out[n - 2] = turn(face, quarters);
+
+                    return;
+                }
+
+                // The opposite-face turn may now meet a turn of its own face.
+                Move between = out[n - 1];
+
+                out.resize(n - 2);
+                append(out, between);
+
+                return;
+            }
+
+            out.push_back(move);
+        }
+
+        std::vector<Move> merge(const std::vector<Move>& moves)
+        {
+            std::vector<Move> out;
+
+            out.reserve(moves.size());
+
+            for (Move move : moves) {append(out, move);}
+
+            return out;
+        }
+
+        // first followed by second, as a state reached from solved.
+        static CubieState compose(const CubieState& first, const CubieState& second) noexcept
+        {
+            CubieState s;
+
+            for (byte p = 0; p < 8; ++p)
+            {
+                s.cp[p] = first.cp[second.cp[p]];
+                s.co[p] = static_cast<byte>((first.co[second.cp[p]] + second.co[p]) % 3);
+            }
+
+            for (byte p = 0; p < 12; ++p)
+            {
+                s.ep[p] = first.ep[second.ep[p]];
+                s.eo[p] = first.eo[second.ep[p]] ^ second.eo[p];
+            }
+
+            return s;
+        }
+
+        // Sequences of up to five moves packed as a 3-bit length and 5 bits per move.
+        using PackedMoves = std::uint32_t;
+
+        static PackedMoves packMoves(const std::vector<Move>& moves) noexcept
+        {
+            PackedMoves p = static_cast<PackedMoves>(moves.size());
+
+            for (regi i = 0; i < moves.size(); ++i) {p |= static_cast<PackedMoves>(moves[i]) << (3 + 5 * i);}
+
+            return p;
+        }
+
+        static std::vector<Move> unpackMoves(PackedMoves p)
+        {
+            std::vector<Move> moves(p & 7);
+
+            for (regi i = 0; i < moves.size(); ++i) {moves[i] = static_cast<Move>((p >> (3 + 5 * i)) & 31);}
+
+            return moves;
+        }
+
+        struct Prefix
+        {
+            std::vector<Move> moves;
+            CubieState inverse;
+        };
+
+        // Open-addressing hash table from state to a shortest sequence, 16 bytes per slot. Each
+        // piece takes 5 bits (position * base + orientation); the last edge is implied by the others.
+        // The first word holds the corners and edges 0-3, the second edges 4-10 and the sequence.
+        struct Slot
+        {
+            std::uint64_t first;
+            std::uint64_t second;
+        };
+
+        constexpr const std::uint64_t emptySlot = UINT64_MAX;
+        constexpr const regi keyBits = 35;
+
+        static Slot key(const CubieState& s) noexcept
+        {
+            Slot k{0, 0};
+
+            for (byte p = 0; p < 8; ++p) {k.first = k.first << 5 | (s.cp[p] * 3 + s.co[p]);}
+            for (byte p = 0; p < 4; ++p) {k.first = k.first << 5 | (s.ep[p] * 2 + s.eo[p]);}
+            for (byte p = 4; p < 11; ++p) {k.second = k.second << 5 | (s.ep[p] * 2 + s.eo[p]);}
+
+            return k;
+        }
+
+        static regi hash(const Slot& k) noexcept
+        {
+            std::uint64_t h = k.first * 0x9E3779B97F4A7C15ull ^ k.second;
+
+            h ^= h >> 31;
+            h *= 0xBF58476D1CE4E5B9ull;
+            h ^= h >> 29;
+
+            return static_cast<regi>(h);
+        }
+
+        struct Table
+        {
+            std::vector<Slot> slots;
+            regi mask = 0;
+            std::vector<Prefix> prefixes;
+        };
+
+        // Calls visit(state, moves) for every canonical sequence of at most maxDepth moves, shortest first.
+        template <class Visit>
+        static void enumerate(byte maxDepth, const Visit& visit)
+        {
+            auto any = [](const CubieState&) {return true;};
+
+            for (const std::vector<Move>& moves : search::enumerate<search::allMoves>(CubieState(), maxDepth, Face::NULL_FACE, Face::NULL_FACE, {}, any))
+            {
+                CubieState state;
+
+                for (Move move : moves) {search::apply(state, move);}
+
+                visit(state, moves);
+            }
+        }
+
+        static std::vector<Move> inverse(const std::vector<Move>& moves)
+        {
+            std::vector<Move> out;
+
+            for (regi i = moves.size(); i-- > 0;) {out.push_back(turn(static_cast<byte>(moves[i]) / 3, 4 - amount(moves[i])));}
+
+            return out;
+        }
+
+        // Set once table() has finished building, so deadline-bounded callers can avoid paying for it.
+        static std::atomic<bool> tableBuilt(false);
+
+        static const Table& table()
+        {
+            static const Table t = []
+            {
+                Table t;
+
+                t.slots.assign(regi(1) << 20, Slot{emptySlot, 0});
+                t.mask = t.slots.size() - 1;
+
+                // Keeps the shorter sequence when a state is reached twice.
+                enumerate(tableDepth, [&t](const CubieState& s, const std::vector<Move>& m)
+                {
+                    Slot k = key(s);
+                    std::uint64_t value = static_cast<std::uint64_t>(packMoves(m)) << keyBits;
+
+                    for (regi i = hash(k) & t.mask;; i = (i + 1) & t.mask)
+                    {
+                        Slot& slot = t.slots[i];
+
+                        if (slot.first == emptySlot) {slot = Slot{k.first, k.second | value}; return;}
+                        if (slot.first != k.first || (slot.second & ((std::uint64_t(1) << keyBits) - 1)) != k.second) {continue;}
+                        if ((slot.second >> keyBits & 7) > m.size()) {slot.second = k.second | value;}
+
+                        return;
+                    }
+                });
+
+                enumerate(prefixDepth, [&t](const CubieState&, const std::vector<Move>& m)
+                {
+                    if (m.empty()) {return;}
+
+                    CubieState s;
+
+                    for (Move move : inverse(m)) {search::apply(s, move);}
+
+                    t.prefixes.push_back(Prefix{m, s});
+                });
+
+                std::stable_sort(t.prefixes.begin(), t.prefixes.end(), [](const Prefix& a, const Prefix& b) {return a.moves.size() < b.moves.size();});
+                tableBuilt.store(true, std::memory_order_release);
+
+                return t;
+            }();
+
+            return t;
+        }
+
+        static std::optional<PackedMoves> lookup(const Table& t, const CubieState& state) noexcept
+        {
+            Slot k = key(state);
+
+            for (regi i = hash(k) & t.mask;; i = (i + 1) & t.mask)
+            {
+                const Slot& slot = t.slots[i];
+
+                if (slot.first == emptySlot) {return std::nullopt;}
+                if (slot.first == k.first && (slot.second & ((std::uint64_t(1) << keyBits) - 1)) == k.second)
+                {
+                    return static_cast<PackedMoves>(slot.second >> keyBits);
+                }
+            }
+        }
+
+        // Shortest sequence reaching effect from solved with fewer than below moves.
+        static std::optional<std::vector<Move>> find(const CubieState& effect, regi below)
+        {
+            const Table& t = table();
+
+            if (std::optional<PackedMoves> direct = lookup(t, effect))
+            {
+                if ((*direct & 7) < below) {return unpackMoves(*direct);}
+
+                return std::nullopt;
+            }
+
+            // More than tableDepth moves are needed, so a prefix is. Prefixes are sorted shortest first.
+            if (below <= tableDepth + 1) {return std::nullopt;}
+
+            std::optional<std::vector<Move>> best;
+
+            for (const Prefix& prefix : t.prefixes)
+            {
+                // Any sequence of length L shorter than the current target is found with a prefix of
+                // L - tableDepth moves, so longer prefixes can be skipped.
+                if (prefix.moves.size() + tableDepth + 1 > (best ? best->size() : below)) {break;}
+
+                std::optional<PackedMoves> rest = lookup(t, compose(prefix.inverse, effect));
+
+                if (!rest) {continue;}
+
+                regi length = prefix.moves.size() + (*rest & 7);
+
+                if (length < below && (!best || length < best->size()))
+                {
+                    best = prefix.moves;
+
+                    for (Move move : unpackMoves(*rest)) {best->push_back(move);}
+                }
+            }
+
+            return best;
+        }
+
+        std::optional<std::vector<Move>> shortest(const std::vector<Move>& moves)
+        {
+            CubieState effect;
+
+            for (Move move : moves) {search::apply(effect, move);}
+
+            if (effect.isSolved()) {return std::vector<Move>{};}
+
+            return find(effect, tableDepth + prefixDepth + 1);
+        }
+
+        std::vector<Move> optimise(const std::vector<Move>& moves, const Deadline& deadline, const SimplifyConfig& config)
+        {
+            std::vector<Move> out = merge(moves);
+            bool changed = true;
+
+            // Building the table takes far longer than a typical deadline.
+            if (!deadline.unbounded() && !tableBuilt.load(std::memory_order_acquire)) {return out;}
+
+            while (changed && !deadline.expired())
+            {
+                changed = false;
+
+                for (regi k = std::min<regi>(config.window, out.size()); k >= 3; --k)
+                {
+                    for (regi i = 0; i + k <= out.size(); ++i)
+                    {
+                        if (deadline.expired()) {return out;}
+
+                        CubieState effect;
+
+                        for (regi j = i; j < i + k; ++j) {search::apply(effect, out[j]);}
+
+                        std::optional<std::vector<Move>> shorter = effect.isSolved() ? std::vector<Move>{} : find(effect, k);
+
+                        if (!shorter) {continue;}
+
+                        std::vector<Move> next(out.begin(), out.begin() + i);
+
+                        next.insert(next.end(), shorter->begin(), shorter->end());
+                        next.insert(next.end(), out.begin() + i + k, out.end());
+                        out = merge(next);
+                        changed = true;
+                    }
+                }
+            }
+
+            return out;
+        }
+
+        void prepare()
+        {
+            static_cast<void>(table());
+        }
+    }
+}
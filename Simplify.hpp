@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Search.hpp"
+#include "SearchControl.hpp"
+#include <optional>
+
+namespace slvr
+{
+    // Post-pass over finished solutions. Phase solutions are found independently, so they cancel
+    // at the boundaries and contain stretches that have shorter equivalents.
+    namespace simplify
+    {
+        // Every state within tableDepth moves of solved is tabulated with a shortest sequence.
+        // Longer windows are looked up through every prefix of up to prefixDepth moves, so
+        // replacements of up to tableDepth + prefixDepth moves are found.
+        constexpr const byte tableDepth  = 5;
+        constexpr const byte prefixDepth = 2;
+
+        struct SimplifyConfig
+        {
+            byte window = 10;  // longest window that is replaced as a whole
+        };
+
+        // Merges adjacent turns of the same face, also across a turn of the opposite face, and
+        // drops those that cancel.
+        [[nodiscard]] std::vector<Move> merge(const std::vector<Move>& moves);
+
+        // Shortest sequence with the same effect as moves, if one of at most
+        // tableDepth + prefixDepth moves exists.
+        [[nodiscard]] std::optional<std::vector<Move>> shortest(const std::vector<Move>& moves);
+
+        // merge(), then repeatedly replaces windows of up to config.window moves with shortest
+        // equivalents until nothing changes or the deadline passes. With a bounded deadline only
+        // merge() runs until the table has been built, by prepare() or an unbounded call.
+        [[nodiscard]] std::vector<Move> optimise(const std::vector<Move>& moves, const Deadline& deadline = Deadline::never(),
+                                                 const SimplifyConfig& config = {});
+
+        // Builds the sequence table now rather than on first use, so that deadline-bounded calls
+        // to optimise() get the full pass.
+        void prepare();
+    }
+}
@@ -0,0 +1,145 @@
+#include "SolutionCache.hpp"
+
+namespace slvr
+{
+    double CacheStats::hitRate() const noexcept
+    {
+        regi lookups = hits + misses;
+
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+
+    SolutionCache::SolutionCache(regi capacity) :
+        shardCapacity_(std::max<regi>(1, (capacity + numShards - 1) / numShards)),
+        hits_(0),
+        misses_(0),
+        inserts_(0),
+        evictions_(0)
+    {}
+
+    SolutionCache::Shard& SolutionCache::shard(const PackedCube& state) noexcept
+    {
+        return shards_[PackedCubeHash()(state) % numShards];
+    }
+
+    std::optional<std::vector<Move>> SolutionCache::find(const Cube& cube)
+    {
+        sym::Canonical canon = sym::canonical(cube);
+        Shard& s = shard(canon.state);
+        std::vector<Move> stored;
+
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+
+            auto it = s.index.find(canon.state);
+
+            if (it == s.index.end())
+            {
+                misses_.fetch_add(1, std::memory_order_relaxed);
+
+                return std::nullopt;
+            }
+
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+            stored = it->second->second;
+        }
+
+        hits_.fetch_add(1, std::memory_order_relaxed);
+
+        return sym::fromCanonical(stored, canon);
+    }
+
+    void SolutionCache::insert(const Cube& cube, const std::vector<Move>& solution)
+    {
+        sym::Canonical canon = sym::canonical(cube);
+        std::vector<Move> stored = sym::toCanonical(solution, canon);
+        Shard& s = shard(canon.state);
+
+        std::lock_guard<std::mutex> lock(s.mtx);
+
+        auto it = s.index.find(canon.state);
+
+        if (it != s.index.end())
+        {
+            if (stored.size() < it->second->second.size()) {it->second->second = std::move(stored);}
+
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+
+            return;
+        }
+
+        s.lru.emplace_front(canon.state, std::move(stored));
+        s.index.emplace(canon.state, s.lru.begin());
+
+        inserts_.fetch_add(1, std::memory_order_relaxed);
+
+        if (s.lru.size() > shardCapacity_)
+        {
+            s.index.erase(s.lru.back().first);
+            s.lru.pop_back();
+
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    thistlethwaite::SolveResult SolutionCache::solve(const Cube& cube, const SearchLimits& limits,
+                                                     const thistlethwaite::SolveOptions& options)
+    {
+        if (std::optional<std::vector<Move>> hit = find(cube))
+        {
+            thistlethwaite::SolveResult result;
+
+            result.solution = std::move(*hit);
+            result.reached = thistlethwaite::State::G4;
+            result.solved = true;
+
+            return result;
+        }
+
+        thistlethwaite::SolveResult result = thistlethwaite::solve(cube, limits, options);
+
+        if (result.solved) {insert(cube, result.solution);}
+
+        return result;
+    }
+
+    regi SolutionCache::capacity() const noexcept {return shardCapacity_ * numShards;}
+
+    regi SolutionCache::size()
+    {
+        regi n = 0;
+
+        for (Shard& s : shards_)
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+
+            n += s.lru.size();
+        }
+
+        return n;
+    }
+
+    CacheStats SolutionCache::stats()
+    {
+        CacheStats out;
+
+        out.hits      = hits_.load(std::memory_order_relaxed);
+        out.misses    = misses_.load(std::memory_order_relaxed);
+        out.inserts   = inserts_.load(std::memory_order_relaxed);
+        out.evictions = evictions_.load(std::memory_order_relaxed);
+        out.size      = size();
+
+        return out;
+    }
+
+    void SolutionCache::clear()
+    {
+        for (Shard& s : shards_)
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+
+            s.index.clear();
+            s.lru.clear();
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Solver.hpp"
+#include "Symmetry.hpp"
+#include <list>
+#include <unordered_map>
+
+namespace slvr
+{
+    struct CacheStats
+    {
+        regi hits      = 0;
+        regi misses    = 0;
+        regi inserts   = 0;
+        regi evictions = 0;
+        regi size      = 0;
+
+        [[nodiscard]] double hitRate() const noexcept;
+    };
+
+    // Bounded LRU cache of solutions keyed by the symmetry- and inverse-canonical packed state,
+    // split into independently locked shards.
+    class SolutionCache
+    {
+    private:
+        static constexpr regi numShards = 16;
+
+        struct Shard
+        {
+            using Entry = std::pair<PackedCube, std::vector<Move>>;
+
+            std::list<Entry> lru;
+            std::unordered_map<PackedCube, std::list<Entry>::iterator, PackedCubeHash> index;
+            std::mutex mtx;
+        };
+
+        std::array<Shard, numShards> shards_;
+        regi shardCapacity_;
+        std::atomic<regi> hits_;
+        std::atomic<regi> misses_;
+        std::atomic<regi> inserts_;
+        std::atomic<regi> evictions_;
+
+        [[nodiscard]] Shard& shard(const PackedCube& state) noexcept;
+
+    public:
+        explicit SolutionCache(regi capacity);
+        SolutionCache(const SolutionCache&) = delete;
+        SolutionCache& operator=(const SolutionCache&) = delete;
+
+        [[nodiscard]] std::optional<std::vector<Move>> find(const Cube& cube);
+        void insert(const Cube& cube, const std::vector<Move>& solution);
+
+        [[nodiscard]] thistlethwaite::SolveResult solve(const Cube& cube, const SearchLimits& limits = {},
+                                                        const thistlethwaite::SolveOptions& options = {});
+
+        [[nodiscard]] regi capacity() const noexcept;
+        [[nodiscard]] regi size();
+        [[nodiscard]] CacheStats stats();
+
+        void clear();
+    };
+}
@@ -1,106 +1,230 @@
-#include "Solver.hpp"
-
-namespace slvr
-{
-    namespace nogroup
-    {
-        bool dfs(Cube& cube, regi depth, regi maxDepth)
-        {
-            if (cube.isSolved()) {return true;}
-            if (depth == maxDepth) {return false;}
-
-            for (byte i = 0; i < 18; ++i)
-            {
-                Move move = static_cast<Move>(i);
-
-                Face cubeFace = cube.lastFace();
-                Face moveFace = toFace(move);
-
-                if (cubeFace == moveFace) {continue;}
-
-                if (moveFace == opposite(cubeFace) && moveFace == cube.secondLastFace()) {continue;}
-
-                cube += move;
-
-                if (dfs(cube, depth + 1, maxDepth)) {return true;}
-
-                cube.undo();
-            }
-
-            return false;
-        }
-    }
-
-    namespace thistlethwaite
-    {
-        bool inG1(const Cube& cube) noexcept
-        {
-            if (cube.edgeOrientations() != edge_arr{0}) {return false;}
-
-            return true;
-        }
-
-        bool inG2(const Cube& cube) noexcept
-        {
-            if (!inG1(cube)) {return false;}
-
-            if (cube.cornerOrientations() != corner_arr{0}) {return false;}
-
-            for (byte i = 4; i < 8; ++i)
-            {
-                if (cube.edgePositions()[i] < 4 || cube.edgePositions()[i] > 7) {return false;}
-            }
-
-            return true;
-        }
-
-        bool inG3(const Cube& cube) noexcept
-        {
-            if (!inG2(cube)) {return false;}
-
-            corner_arr corners(cube.cornerPositions());
-            edge_arr edges(cube.edgePositions());
-
-            for (byte i = 0; i < 8; ++i)
-            {
-                byte corner = corners[i];
-
-                if (i == 0 || i == 2 || i == 5 || i == 7)
-                {
-                    if (corner != 0 && corner != 2 && corner != 5 && corner != 7) {return false;}
-                }
-            }
-
-            for (byte i = 0; i < 12; ++i)
-            {
-                byte edge = edges[i];
-
-                if (i == 0 || i == 2 || i == 8 || i == 10)
-                {
-                    if (edge != 0 && edge != 2 && edge != 8 && edge != 10) {return false;}
-                }
-
-                if (i == 1 || i == 3 || i == 9 || i == 11)
-                {
-                    if (edge != 1 && edge != 3 && edge != 9 && edge != 11) {return false;}
-                }
-            }
-
-            return true;
-        }
-
-        State state(const Cube& cube) noexcept
-        {
-            if (!inG1(cube)) {return State::G0;}
-            if (!inG2(cube)) {return State::G1;}
-            if (cube.isSolved()) {return State::G4;}
-            if (!inG3(cube)) {return State::G2;}
-            return State::G3;
-        }
-    }
-
-    namespace kociemba
-    {
-
-    }
+#include "Solver.hpp"
+#include "Simplify.hpp"
+
+namespace slvr
+{
+    namespace nogroup
+    {
+        bool dfs(Cube& cube, regi depth, regi maxDepth)
+        {
+            std::atomic<bool> solutionFound(false);
+            SearchLimits limits;
+            SearchContext ctx(solutionFound, limits);
+
+            return dfs(cube, depth, maxDepth, ctx);
+        }
+
+        bool dfs(Cube& cube, regi depth, regi maxDepth, SearchContext& ctx)
+        {
+            if (depth > maxDepth) {return false;}
+
+            std::vector<Move> path;
+            auto solved = [](const CubieState& s) {return s.isSolved();};
+
+            if (!search::run<thistlethwaite::g0Moves>(CubieState(cube), maxDepth - depth, cube.lastFace(), cube.secondLastFace(),
+                                                              path, ctx, solved, pruning::heuristic(pruning::TableId::CORNERS, ctx.deadline())))
+            {
+                return false;
+            }
+
+            for (Move move : path) {cube += move;}
+
+            return true;
+        }
+
+        Generator<std::vector<Move>> solutions(const Cube& cube, regi maxLength, const SearchLimits& limits)
+        {
+            auto solved = [](const CubieState& s) {return s.isSolved();};
+
+            return search::enumerate<thistlethwaite::g0Moves>(CubieState(cube), maxLength, cube.lastFace(), cube.secondLastFace(),
+                                                              limits, solved, pruning::heuristic(pruning::TableId::CORNERS, limits.deadline));
+        }
+
+        std::optional<std::vector<Move>> solve(const Cube& cube, regi maxLength, const SearchLimits& limits, regi threads)
+        {
+            auto solved = [](const CubieState& s) {return s.isSolved();};
+
+            return search::parallelRun<thistlethwaite::g0Moves>(CubieState(cube), maxLength, cube.lastFace(), cube.secondLastFace(), limits,
+                                                                solved, pruning::heuristic(pruning::TableId::CORNERS, limits.deadline), threads);
+        }
+    }
+
+    namespace thistlethwaite
+    {
+        const std::vector<corner_arr>& halfTurnCorners()
+        {
+            static const std::vector<corner_arr> corners = []
+            {
+                std::vector<corner_arr> found{Cube().cornerPositions()};
+
+                for (regi i = 0; i < found.size(); ++i)
+                {
+                    for (Move move : g3Moves)
+                    {
+                        Cube c(found[i], corner_arr{}, Cube().edgePositions(), edge_arr{});
+
+                        c.applyMove(move);
+
+                        if (std::find(found.begin(), found.end(), c.cornerPositions()) == found.end())
+                        {
+                            found.push_back(c.cornerPositions());
+                        }
+                    }
+                }
+
+                std::sort(found.begin(), found.end());
+
+                return found;
+            }();
+
+            return corners;
+        }
+
+        // In parallel mode maxDepth is the phase's depth bound and the search deepens by itself.
+        template <State G>
+        static std::optional<Cube> nextGroup(Cube& cube, regi maxDepth, const SearchLimits& limits, const SolveOptions& options)
+        {
+            if (options.parallel)
+            {
+                std::optional<std::vector<Move>> path =
+                    search::parallelRun<validMoves<G>()>(CubieState(cube), maxDepth, cube.lastFace(), cube.secondLastFace(), limits, NextGroup<G>(),
+                                                         pruning::heuristic(pruning::phaseTable(static_cast<byte>(G)), limits.deadline), options.threads);
+
+                if (!path) {return std::nullopt;}
+
+                Cube next = cube;
+
+                for (Move move : *path) {next += move;}
+
+                return next;
+            }
+
+            std::atomic<bool> solutionFound(false);
+            SearchContext ctx(solutionFound, limits);
+            Cube next = cube;
+
+            if (dfsNextGroup<G>(next, 0, maxDepth, ctx)) {return next;}
+
+            return std::nullopt;
+        }
+
+        static std::optional<Cube> nextGroup(State g, Cube& cube, regi maxDepth, const SearchLimits& limits, const SolveOptions& options)
+        {
+            switch (g)
+            {
+                case State::G0: return nextGroup<State::G0>(cube, maxDepth, limits, options);
+                case State::G1: return nextGroup<State::G1>(cube, maxDepth, limits, options);
+                case State::G2: return nextGroup<State::G2>(cube, maxDepth, limits, options);
+                case State::G3: return nextGroup<State::G3>(cube, maxDepth, limits, options);
+                default:        return std::nullopt;
+            }
+        }
+
+        static bool improve(const Cube& cube, SolveResult& best, const SearchLimits& limits, const SolveOptions& options)
+        {
+            SLVR_TRACE_SPAN("improve");
+
+            if (options.parallel && !best.solution.empty())
+            {
+                std::optional<std::vector<Move>> shorter = nogroup::solve(cube, best.solution.size() - 1, limits, options.threads);
+
+                if (shorter) {best.solution = std::move(*shorter);}
+
+                best.optimal = shorter || !limits.reached();
+
+                return shorter.has_value();
+            }
+
+            std::atomic<bool> solutionFound(false);
+            SearchContext ctx(solutionFound, limits);
+            regi n = best.solution.size();
+
+            for (regi maxDepth = 0; maxDepth < n; ++maxDepth)
+            {
+                SLVR_TRACE_SPAN("iteration", static_cast<std::int64_t>(maxDepth));
+
+                Cube c = cube;
+
+                if (nogroup::dfs(c, 0, maxDepth, ctx))
+                {
+                    best.solution = c.solution();
+                    best.optimal = true;
+
+                    return true;
+                }
+
+                if (ctx.interrupted() || limits.reached()) {return false;}
+            }
+
+            best.optimal = true;
+
+            return false;
+        }
+
+        SolveResult solve(const Cube& cube, const SearchLimits& limits, const SolveOptions& options)
+        {
+            SLVR_TRACE_SPAN("solve");
+
+            SolveResult best;
+            const Cube start(cube.cornerPositions(), cube.cornerOrientations(), cube.edgePositions(), cube.edgeOrientations());
+            Cube current = start;
+
+            best.reached = state(current);
+
+            while (best.reached != State::G4)
+            {
+                std::optional<Cube> next;
+                byte phase = static_cast<byte>(best.reached);
+
+                SLVR_TRACE_SPAN("phase", phase);
+
+                if (options.parallel)
+                {
+                    if (limits.reached()) {SLVR_TRACE_INSTANT("timeout", phase); best.timedOut = true; return best;}
+
+                    next = nextGroup(best.reached, current, maxPhaseDepths[phase], limits, options);
+                }
+
+                for (regi maxDepth = 1; maxDepth <= maxPhaseDepths[phase] && !next && !options.parallel; ++maxDepth)
+                {
+                    if (limits.reached()) {SLVR_TRACE_INSTANT("timeout", phase); best.timedOut = true; return best;}
+
+                    SLVR_TRACE_SPAN("iteration", static_cast<std::int64_t>(maxDepth));
+
+                    next = nextGroup(best.reached, current, maxDepth, limits, options);
+                }
+
+                if (!next) {best.timedOut = limits.reached(); return best;}
+
+                current = std::move(*next);
+                best.reached = state(current);
+                best.solution = current.solution();
+            }
+
+            best.solved = true;
+
+            if (options.simplify)
+            {
+                SLVR_TRACE_SPAN("simplify");
+
+                best.solution = simplify::optimise(best.solution, limits.deadline);
+            }
+
+            if (best.solution.empty()) {best.optimal = true; return best;}
+
+            // Without the corner table the search for a shorter solution is unpruned and can only
+            // run out the deadline. A solved result that wasn't improved has not timed out.
+            if (options.improve && !limits.deadline.unbounded() && pruning::built(pruning::TableId::CORNERS))
+            {
+                improve(start, best, limits, options);
+            }
+
+            return best;
+        }
+    }
+
+    namespace kociemba
+    {
+
+    }
 }
\ No newline at end of file
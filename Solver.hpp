@@ -1,161 +1,229 @@
-#pragma once
-
-#include "Cube.hpp"
-#include <thread>
-#include <mutex>
-#include <atomic>
-
-namespace slvr
-{
-    namespace nogroup
-    {
-        bool dfs(Cube& cube, regi depth, regi maxDepth);
-    }
-
-    namespace thistlethwaite
-    {
-        enum class State : byte
-        {
-            G0, // < U,  D,  R,  L,  F,  B>
-            G1, // < U,  D,  R,  L, F2, B2>
-            G2, // < U,  D, R2, L2, F2, B2>
-            G3, // <U2, D2, R2, L2, F2, B2>
-            G4  // <>
-        };
-
-        constexpr const std::array<Move, 18> g0Moves {Move::R, Move::R_PRIME, Move::R2,
-		                                              Move::L, Move::L_PRIME, Move::L2,
-                                                      Move::U, Move::U_PRIME, Move::U2,
-                                                      Move::D, Move::D_PRIME, Move::D2,
-                                                      Move::F, Move::F_PRIME, Move::F2,
-                                                      Move::B, Move::B_PRIME, Move::B2};
-        
-        constexpr const std::array<Move, 14> g1Moves {Move::R, Move::R_PRIME, Move::R2,
-		                                              Move::L, Move::L_PRIME, Move::L2,
-                                                      Move::U, Move::U_PRIME, Move::U2,
-                                                      Move::D, Move::D_PRIME, Move::D2,
-                                                      Move::F2,
-                                                      Move::B2};
-
-        constexpr const std::array<Move, 10> g2Moves {Move::R2,
-		                                              Move::L2,
-                                                      Move::U, Move::U_PRIME, Move::U2,
-                                                      Move::D, Move::D_PRIME, Move::D2,
-                                                      Move::F2,
-                                                      Move::B2};
-
-        constexpr const std::array<Move,  6> g3Moves {Move::R2,
-		                                              Move::L2,
-                                                      Move::U2,
-                                                      Move::D2,
-                                                      Move::F2,
-                                                      Move::B2};
-
-        template <State G>
-        constexpr const auto& validMoves() noexcept;
-
-        template<> constexpr const auto& validMoves<State::G0>() noexcept {return g0Moves;}
-        template<> constexpr const auto& validMoves<State::G1>() noexcept {return g1Moves;}
-        template<> constexpr const auto& validMoves<State::G2>() noexcept {return g2Moves;}
-        template<> constexpr const auto& validMoves<State::G3>() noexcept {return g3Moves;}
-
-        constexpr const byte numG0(18),
-                             numG1(14),
-                             numG2(10),
-                             numG3( 6);
-
-        template <State G>
-        constexpr const byte numMoves() noexcept;
-
-        template<> constexpr const byte numMoves<State::G0>() noexcept {return numG0;}
-        template<> constexpr const byte numMoves<State::G1>() noexcept {return numG1;}
-        template<> constexpr const byte numMoves<State::G2>() noexcept {return numG2;}
-        template<> constexpr const byte numMoves<State::G3>() noexcept {return numG3;}
-        
-        [[nodiscard]] bool inG1(const Cube& cube) noexcept;
-        [[nodiscard]] bool inG2(const Cube& cube) noexcept;
-        [[nodiscard]] bool inG3(const Cube& cube) noexcept;
-
-        [[nodiscard]] State state(const Cube& cube) noexcept;
-
-        template <State G>
-        bool dfsNextGroup(Cube& cube, regi depth, regi maxDepth, std::atomic<bool>& solutionFound)
-        {
-            if (static_cast<byte>(G) < static_cast<byte>(state(cube))) {return true;}
-            if (depth == maxDepth) {return false;}
-            if (solutionFound.load(std::memory_order_relaxed)) {return false;}
-
-            auto moves = validMoves<G>();
-
-            for (Move move : moves)
-            {
-                if (cube.pruneMove(move)) {continue;}
-
-                cube += move;
-
-                if (solutionFound.load(std::memory_order_relaxed)) {cube.undo(); return false;}
-
-                if (dfsNextGroup<G>(cube, depth + 1, maxDepth, solutionFound)) {return true;}
-
-                cube.undo();
-            }
-
-            return false;
-        }
-        
-        template<> inline bool dfsNextGroup<State::G4>(Cube& cube, regi depth, regi maxDepth, std::atomic<bool>& solutionFound) 
-        {return false;}
-
-        template <State G>
-        Cube dfsNextGroupThread(Cube& cube, regi depth, regi maxDepth)
-        {
-            if (static_cast<byte>(G) < static_cast<byte>(state(cube))) {return cube;}
-            if (depth == maxDepth) {return Cube();}
-
-            std::atomic<bool> solutionFound(false);
-            std::mutex mtx;
-            Cube result;
-
-            auto moves = validMoves<G>();
-            const byte n = numMoves<G>();
-
-            std::array<std::thread, n> threads;
-
-            for (byte i = 0; i < n; ++i)
-            {
-                Cube next = cube + moves[i];
-
-                threads[i] = std::thread([&, next = std::move(next)] mutable 
-                {
-                    if (solutionFound.load(std::memory_order_relaxed)) {return;}
-
-                    if (dfsNextGroup<G>(next, depth + 1, maxDepth, solutionFound))
-                    {
-                        if (!solutionFound.exchange(true, std::memory_order_relaxed)) 
-                        {
-                            std::lock_guard<std::mutex> lock(mtx);
-
-                            result = std::move(next);
-                        }
-                    }
-                });
-
-                if (solutionFound.load()) {break;}
-            }
-
-            for (auto& t : threads)
-            {
-                if (t.joinable()) {t.join();}
-            }
-
-            return result;
-        }
-
-        template<> inline Cube dfsNextGroupThread<State::G4>(Cube& cube, regi depth, regi maxDepth) {return Cube();}
-    }
-
-    namespace kociemba
-    {
-
-    }
+#pragma once
+
+#include "Cube.hpp"
+#include "SearchControl.hpp"
+#include "Search.hpp"
+#include "Pruning.hpp"
+#include "ParallelSearch.hpp"
+#include <algorithm>
+#include <optional>
+#include <atomic>
+
+namespace slvr
+{
+    namespace nogroup
+    {
+        bool dfs(Cube& cube, regi depth, regi maxDepth);
+        bool dfs(Cube& cube, regi depth, regi maxDepth, SearchContext& ctx);
+
+        // Every distinct solution of cube with at most maxLength moves, shortest first, produced on demand.
+        [[nodiscard]] Generator<std::vector<Move>> solutions(const Cube& cube, regi maxLength, const SearchLimits& limits = {});
+
+        // Optimal solution of at most maxLength moves by parallel IDA*; threads == 0 uses every hardware thread.
+        [[nodiscard]] std::optional<std::vector<Move>> solve(const Cube& cube, regi maxLength, const SearchLimits& limits = {},
+                                                             regi threads = 0);
+    }
+
+    namespace thistlethwaite
+    {
+        enum class State : byte
+        {
+            G0, // < U,  D,  R,  L,  F,  B>
+            G1, // < U,  D,  R,  L, F2, B2>
+            G2, // < U,  D, R2, L2, F2, B2>
+            G3, // <U2, D2, R2, L2, F2, B2>
+            G4  // <>
+        };
+
+        constexpr const std::array<Move, 18> g0Moves {Move::R, Move::R_PRIME, Move::R2,
+		                                              Move::L, Move::L_PRIME, Move::L2,
+                                                      Move::U, Move::U_PRIME, Move::U2,
+                                                      Move::D, Move::D_PRIME, Move::D2,
+                                                      Move::F, Move::F_PRIME, Move::F2,
+                                                      Move::B, Move::B_PRIME, Move::B2};
+        
+        constexpr const std::array<Move, 14> g1Moves {Move::R, Move::R_PRIME, Move::R2,
+		                                              Move::L, Move::L_PRIME, Move::L2,
+                                                      Move::U, Move::U_PRIME, Move::U2,
+                                                      Move::D, Move::D_PRIME, Move::D2,
+                                                      Move::F2,
+                                                      Move::B2};
+
+        constexpr const std::array<Move, 10> g2Moves {Move::R2,
+		                                              Move::L2,
+                                                      Move::U, Move::U_PRIME, Move::U2,
+                                                      Move::D, Move::D_PRIME, Move::D2,
+                                                      Move::F2,
+                                                      Move::B2};
+
+        constexpr const std::array<Move,  6> g3Moves {Move::R2,
+		                                              Move::L2,
+                                                      Move::U2,
+                                                      Move::D2,
+                                                      Move::F2,
+                                                      Move::B2};
+
+        template <State G>
+        constexpr const auto& validMoves() noexcept;
+
+        template<> constexpr const auto& validMoves<State::G0>() noexcept {return g0Moves;}
+        template<> constexpr const auto& validMoves<State::G1>() noexcept {return g1Moves;}
+        template<> constexpr const auto& validMoves<State::G2>() noexcept {return g2Moves;}
+        template<> constexpr const auto& validMoves<State::G3>() noexcept {return g3Moves;}
+
+        constexpr const byte numG0(18),
+                             numG1(14),
+                             numG2(10),
+                             numG3( 6);
+
+        template <State G>
+        constexpr const byte numMoves() noexcept;
+
+        template<> constexpr const byte numMoves<State::G0>() noexcept {return numG0;}
+        template<> constexpr const byte numMoves<State::G1>() noexcept {return numG1;}
+        template<> constexpr const byte numMoves<State::G2>() noexcept {return numG2;}
+        template<> constexpr const byte numMoves<State::G3>() noexcept {return numG3;}
+        
+        [[nodiscard]] const std::vector<corner_arr>& halfTurnCorners();
+
+        template <class C>
+        [[nodiscard]] bool inG1(const C& cube) noexcept
+        {
+            if (cube.edgeOrientations() != edge_arr{0}) {return false;}
+
+            return true;
+        }
+
+        template <class C>
+        [[nodiscard]] bool inG2(const C& cube) noexcept
+        {
+            if (!inG1(cube)) {return false;}
+
+            if (cube.cornerOrientations() != corner_arr{0}) {return false;}
+
+            for (byte i = 4; i < 8; ++i)
+            {
+                if (cube.edgePositions()[i] < 4 || cube.edgePositions()[i] > 7) {return false;}
+            }
+
+            return true;
+        }
+
+        template <class C>
+        [[nodiscard]] bool inG3(const C& cube) noexcept
+        {
+            if (!inG2(cube)) {return false;}
+
+            const corner_arr& corners = cube.cornerPositions();
+            const edge_arr& edges = cube.edgePositions();
+
+            for (byte i = 0; i < 8; ++i)
+            {
+                byte corner = corners[i];
+
+                if (i == 0 || i == 2 || i == 5 || i == 7)
+                {
+                    if (corner != 0 && corner != 2 && corner != 5 && corner != 7) {return false;}
+                }
+            }
+
+            for (byte i = 0; i < 12; ++i)
+            {
+                byte edge = edges[i];
+
+                if (i == 0 || i == 2 || i == 8 || i == 10)
+                {
+                    if (edge != 0 && edge != 2 && edge != 8 && edge != 10) {return false;}
+                }
+
+                if (i == 1 || i == 3 || i == 9 || i == 11)
+                {
+                    if (edge != 1 && edge != 3 && edge != 9 && edge != 11) {return false;}
+                }
+            }
+
+            const std::vector<corner_arr>& reachable = halfTurnCorners();
+
+            if (!std::binary_search(reachable.begin(), reachable.end(), corners)) {return false;}
+
+            return true;
+        }
+
+        template <class C>
+        [[nodiscard]] State state(const C& cube) noexcept
+        {
+            if (!inG1(cube)) {return State::G0;}
+            if (!inG2(cube)) {return State::G1;}
+            if (cube.isSolved()) {return State::G4;}
+            if (!inG3(cube)) {return State::G2;}
+            return State::G3;
+        }
+
+        template <State G>
+        struct NextGroup
+        {
+            [[nodiscard]] bool operator()(const CubieState& s) const noexcept
+            {
+                return static_cast<byte>(G) < static_cast<byte>(state(s));
+            }
+        };
+
+        template <State G>
+        bool dfsNextGroup(Cube& cube, regi depth, regi maxDepth, SearchContext& ctx)
+        {
+            if (depth > maxDepth) {return false;}
+
+            std::vector<Move> path;
+
+            if (!search::run<validMoves<G>()>(CubieState(cube), maxDepth - depth, cube.lastFace(), cube.secondLastFace(),
+                                                       path, ctx, NextGroup<G>(), pruning::heuristic(pruning::phaseTable(static_cast<byte>(G)), ctx.deadline())))
+            {
+                return false;
+            }
+
+            for (Move move : path) {cube += move;}
+
+            return true;
+        }
+
+        template<> inline bool dfsNextGroup<State::G4>(Cube&, regi, regi, SearchContext&) {return false;}
+
+        template <State G>
+        bool dfsNextGroup(Cube& cube, regi depth, regi maxDepth, std::atomic<bool>& solutionFound)
+        {
+            SearchLimits limits;
+            SearchContext ctx(solutionFound, limits);
+
+            return dfsNextGroup<G>(cube, depth, maxDepth, ctx);
+        }
+
+        struct SolveOptions
+        {
+            bool parallel = true;
+            bool improve  = true;  // look for a shorter solution until the deadline; needs the corner table planned
+            bool simplify = true;  // merge and shorten the phase output before improving it
+            regi threads  = 0;     // for parallel searches, 0 uses every hardware thread
+        };
+
+        struct SolveResult
+        {
+            std::vector<Move> solution;
+            State reached  = State::G0;
+            bool solved    = false;
+            bool optimal   = false;
+            bool timedOut  = false;
+        };
+
+        constexpr const std::array<byte, 4> maxPhaseDepths {7, 10, 13, 15};
+
+        // A solve with a bounded deadline uses only the pruning and simplify tables that are already
+        // built, and searches without them otherwise, so it can keep a tight budget. Long-lived callers
+        // build them up front with pruning::prepare() and simplify::prepare().
+        [[nodiscard]] SolveResult solve(const Cube& cube, const SearchLimits& limits = {}, const SolveOptions& options = {});
+    }
+
+    namespace kociemba
+    {
+
+    }
 }
\ No newline at end of file
@@ -0,0 +1,516 @@
+#include "StateSet.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#define STATE_SET_IO "State set spill file error"
+
+namespace slvr
+{
+    namespace fs = std::filesystem;
+
+    // Below this many elements per thread the threads cost more than they save.
+    static constexpr regi minChunk = regi(1) << 14;
+    static constexpr regi ioRecords = regi(1) << 16;
+    static constexpr regi blockRecords = regi(1) << 12;  // states per indexed block of a run
+
+    // Runs f(t, begin, end) on threads contiguous chunks of [0, n), the first on the calling thread.
+    template <class F>
+    static void parallelFor(regi threads, regi n, const F& f)
+    {
+        std::vector<std::thread> workers;
+
+        for (regi t = 1; t < threads; ++t) {workers.emplace_back([&, t] {f(t, n * t / threads, n * (t + 1) / threads);});}
+
+        f(0, 0, n / threads);
+
+        for (auto& w : workers) {w.join();}
+    }
+
+    static regi threadsFor(regi threads, regi n) noexcept
+    {
+        return std::clamp<regi>(std::min(threads, n / minChunk), 1, std::max<regi>(threads, 1));
+    }
+
+    // Digits of the 67-bit key, least significant first: edges, then corners.
+    struct Digit
+    {
+        bool corners;
+        byte shift;
+        byte bits;
+    };
+
+    static constexpr std::array<Digit, 7> digits {{{false, 0, 11}, {false, 11, 11}, {false, 22, 11}, {false, 33, 7},
+                                                   {true, 0, 11}, {true, 11, 11}, {true, 22, 5}}};
+
+    // Stable parallel LSD radix sort by key(element). Each pass counts digits per chunk, turns the
+    // counts into per-chunk offsets and scatters; passes where every key has the same digit are skipped.
+    template <class T, class Key>
+    static void radixSort(std::vector<T>& v, regi threads, const Key& key)
+    {
+        regi n = v.size();
+
+        if (n < 2) {return;}
+
+        threads = threadsFor(threads, n);
+
+        std::vector<T> tmp(n);
+        std::vector<std::vector<regi>> counts(threads, std::vector<regi>(regi(1) << 11));
+
+        for (const Digit& d : digits)
+        {
+            const regi buckets = regi(1) << d.bits;
+            auto digit = [&key, &d, buckets](const T& x) -> regi
+            {
+                const PackedCube& k = key(x);
+
+                return ((d.corners ? k.corners : k.edges) >> d.shift) & (buckets - 1);
+            };
+
+            parallelFor(threads, n, [&](regi t, regi begin, regi end)
+            {
+                std::fill(counts[t].begin(), counts[t].begin() + buckets, 0);
+
+                for (regi i = begin; i < end; ++i) {++counts[t][digit(v[i])];}
+            });
+
+            regi sum = 0;
+            bool single = false;
+
+            for (regi b = 0; b < buckets; ++b)
+            {
+                regi total = 0;
+
+                for (regi t = 0; t < threads; ++t)
+                {
+                    regi c = counts[t][b];
+
+                    counts[t][b] = sum;
+                    sum += c;
+                    total += c;
+                }
+
+                if (total == n) {single = true;}
+            }
+
+            if (single) {continue;}
+
+            parallelFor(threads, n, [&](regi t, regi begin, regi end)
+            {
+                for (regi i = begin; i < end; ++i) {tmp[counts[t][digit(v[i])]++] = v[i];}
+            });
+
+            v.swap(tmp);
+        }
+    }
+
+    void sortUnique(std::vector<PackedCube>& states, regi threads)
+    {
+        radixSort(states, threads, [](const PackedCube& s) -> const PackedCube& {return s;});
+
+        regi n = states.size();
+
+        if (n < 2) {return;}
+
+        threads = threadsFor(threads, n);
+
+        // Each chunk keeps the states that differ from their predecessor, written out at offsets
+        // from a prefix sum of the per-chunk counts.
+        std::vector<regi> kept(threads + 1, 0);
+        std::vector<PackedCube> out;
+
+        parallelFor(threads, n, [&](regi t, regi begin, regi end)
+        {
+            for (regi i = begin; i < end; ++i) {kept[t + 1] += i == 0 || states[i] != states[i - 1];}
+        });
+
+        for (regi t = 0; t < threads; ++t) {kept[t + 1] += kept[t];}
+
+        out.resize(kept[threads]);
+
+        parallelFor(threads, n, [&](regi t, regi begin, regi end)
+        {
+            regi o = kept[t];
+
+            for (regi i = begin; i < end; ++i)
+            {
+                if (i == 0 || states[i] != states[i - 1]) {out[o++] = states[i];}
+            }
+        });
+
+        states.swap(out);
+    }
+
+    Dedup dedup(const std::vector<PackedCube>& inputs, regi threads)
+    {
+        struct Entry
+        {
+            PackedCube key;
+            regi index;
+        };
+
+        regi n = inputs.size();
+        std::vector<Entry> entries(n);
+
+        for (regi i = 0; i < n; ++i) {entries[i] = Entry{inputs[i], i};}
+
+        // Stable, so each run of equal keys starts with its first occurrence.
+        radixSort(entries, threads, [](const Entry& e) -> const PackedCube& {return e.key;});
+
+        std::vector<regi> group(n);
+        std::vector<regi> first;
+
+        for (regi j = 0; j < n; ++j)
+        {
+            if (j == 0 || entries[j].key != entries[j - 1].key) {first.push_back(entries[j].index);}
+
+            group[entries[j].index] = first.size() - 1;
+        }
+
+        Dedup out;
+        std::vector<regi> id(first.size());
+
+        out.unique.reserve(first.size());
+        out.representative.resize(n);
+
+        for (regi i = 0; i < n; ++i)
+        {
+            regi g = group[i];
+
+            if (first[g] == i)
+            {
+                id[g] = out.unique.size();
+                out.unique.push_back(inputs[i]);
+            }
+
+            out.representative[i] = id[g];
+        }
+
+        return out;
+    }
+
+    Dedup dedup(const std::vector<Cube>& inputs, regi threads)
+    {
+        std::vector<PackedCube> packed;
+
+        packed.reserve(inputs.size());
+
+        for (const Cube& cube : inputs) {packed.push_back(pack(cube));}
+
+        return dedup(packed, threads);
+    }
+
+    class SpillReader
+    {
+    private:
+        std::ifstream in_;
+        std::vector<byte> buf_;
+        regi pos_;
+        regi len_;
+
+    public:
+        explicit SpillReader(const std::string& path) :
+            in_(path, std::ios::binary),
+            buf_(ioRecords * packedCubeSize),
+            pos_(0),
+            len_(0)
+        {
+            if (!in_) {throw std::runtime_error(STATE_SET_IO);}
+        }
+
+        bool next(PackedCube& state)
+        {
+            if (pos_ == len_)
+            {
+                in_.read(reinterpret_cast<char*>(buf_.data()), buf_.size());
+                len_ = static_cast<regi>(in_.gcount()) / packedCubeSize;
+                pos_ = 0;
+
+                if (len_ == 0) {return false;}
+            }
+
+            state = readPacked(buf_.data() + pos_++ * packedCubeSize);
+
+            return true;
+        }
+    };
+
+    // Writes one sorted run, indexing the first key of every block as it goes.
+    class SpillWriter
+    {
+    private:
+        std::string path_;
+        std::ofstream out_;
+        std::vector<byte> buf_;
+        regi count_;
+        std::vector<PackedCube> index_;
+
+    public:
+        explicit SpillWriter(std::string path) :
+            path_(std::move(path)),
+            out_(path_, std::ios::binary | std::ios::trunc),
+            count_(0)
+        {
+            if (!out_) {throw std::runtime_error(STATE_SET_IO);}
+
+            buf_.reserve(ioRecords * packedCubeSize);
+        }
+
+        void push(const PackedCube& state)
+        {
+            if (count_++ % blockRecords == 0) {index_.push_back(state);}
+
+            buf_.resize(buf_.size() + packedCubeSize);
+            writePacked(state, buf_.data() + buf_.size() - packedCubeSize);
+
+            if (buf_.size() == buf_.capacity()) {flush();}
+        }
+
+        void flush()
+        {
+            out_.write(reinterpret_cast<const char*>(buf_.data()), buf_.size());
+            buf_.clear();
+
+            if (!out_) {throw std::runtime_error(STATE_SET_IO);}
+        }
+
+        // Finishes the file and reopens it for lookups.
+        SpillRun close()
+        {
+            flush();
+            out_.close();
+
+            if (!out_) {throw std::runtime_error(STATE_SET_IO);}
+
+            SpillRun run{path_, count_, std::move(index_), std::ifstream(path_, std::ios::binary)};
+
+            if (!run.in) {throw std::runtime_error(STATE_SET_IO);}
+
+            return run;
+        }
+    };
+
+    // Block of the run that would hold state, or index.size() if state sorts before all of it.
+    static regi blockOf(const SpillRun& run, const PackedCube& state)
+    {
+        regi b = std::upper_bound(run.index.begin(), run.index.end(), state) - run.index.begin();
+
+        return b == 0 ? run.index.size() : b - 1;
+    }
+
+    static void readBlock(const SpillRun& run, regi b, std::vector<PackedCube>& block)
+    {
+        regi first = b * blockRecords;
+        regi n = std::min(blockRecords, run.size - first);
+        std::vector<byte> buf(n * packedCubeSize);
+
+        run.in.clear();
+        run.in.seekg(static_cast<std::streamoff>(first * packedCubeSize));
+        run.in.read(reinterpret_cast<char*>(buf.data()), buf.size());
+
+        if (!run.in) {throw std::runtime_error(STATE_SET_IO);}
+
+        block.resize(n);
+
+        for (regi i = 0; i < n; ++i) {block[i] = readPacked(buf.data() + i * packedCubeSize);}
+    }
+
+    static void removeRun(SpillRun& run)
+    {
+        std::error_code ec;
+
+        run.in.close();
+        fs::remove(run.path, ec);
+    }
+
+    PackedStateSet::PackedStateSet(StateSetConfig config) :
+        config_(std::move(config)),
+        spilled_(0),
+        nextRun_(0)
+    {}
+
+    PackedStateSet::~PackedStateSet()
+    {
+        for (SpillRun& run : runs_) {removeRun(run);}
+    }
+
+    regi PackedStateSet::insert(std::vector<PackedCube> states)
+    {
+        sortUnique(states, config_.threads);
+
+        // Drop what the runs already hold. states is sorted, so each run is read block by block in
+        // order, and only the blocks some state falls into.
+        if (!runs_.empty() && !states.empty())
+        {
+            std::lock_guard<std::mutex> lock(io_);
+            std::vector<PackedCube> block;
+
+            for (const SpillRun& run : runs_)
+            {
+                regi none = run.index.size();
+                regi loaded = none;
+                regi o = 0;
+
+                for (const PackedCube& s : states)
+                {
+                    regi b = blockOf(run, s);
+
+                    if (b != none && b != loaded) {readBlock(run, b, block); loaded = b;}
+                    if (b == none || !std::binary_search(block.begin(), block.end(), s)) {states[o++] = s;}
+                }
+
+                states.resize(o);
+            }
+        }
+
+        std::vector<PackedCube> merged;
+
+        merged.reserve(states_.size() + states.size());
+        std::set_union(states_.begin(), states_.end(), states.begin(), states.end(), std::back_inserter(merged));
+
+        regi added = merged.size() - states_.size();
+
+        states_.swap(merged);
+
+        if (!config_.spillPath.empty() && states_.size() * sizeof(PackedCube) > config_.ramLimit) {spill();}
+
+        return added;
+    }
+
+    regi PackedStateSet::insert(const std::vector<Cube>& cubes)
+    {
+        std::vector<PackedCube> packed;
+
+        packed.reserve(cubes.size());
+
+        for (const Cube& cube : cubes) {packed.push_back(pack(cube));}
+
+        return insert(std::move(packed));
+    }
+
+    std::string PackedStateSet::runPath()
+    {
+        return config_.spillPath + "." + std::to_string(nextRun_++);
+    }
+
+    // Writes the in-memory states out as a new run.
+    void PackedStateSet::spill()
+    {
+        SpillWriter out(runPath());
+
+        for (const PackedCube& s : states_) {out.push(s);}
+
+        {
+            std::lock_guard<std::mutex> lock(io_);
+
+            runs_.push_back(out.close());
+        }
+
+        spilled_ += states_.size();
+        states_.clear();
+        states_.shrink_to_fit();
+
+        compact();
+    }
+
+    // Merges the newest run into the one before it while that one is no larger, like carries in a
+    // binary counter.
+    void PackedStateSet::compact()
+    {
+        while (runs_.size() > 1 && runs_[runs_.size() - 2].size <= runs_.back().size)
+        {
+            SpillWriter out(runPath());
+
+            {
+                SpillReader older(runs_[runs_.size() - 2].path);
+                SpillReader newer(runs_.back().path);
+                PackedCube a, b;
+                bool moreA = older.next(a);
+                bool moreB = newer.next(b);
+
+                // Runs are disjoint, so there are no ties.
+                while (moreA || moreB)
+                {
+                    if (moreA && (!moreB || a < b)) {out.push(a); moreA = older.next(a);}
+                    else {out.push(b); moreB = newer.next(b);}
+                }
+            }
+
+            SpillRun merged = out.close();
+            std::lock_guard<std::mutex> lock(io_);
+
+            removeRun(runs_.back());
+            runs_.pop_back();
+            removeRun(runs_.back());
+            runs_.back() = std::move(merged);
+        }
+    }
+
+    bool PackedStateSet::contains(const PackedCube& state) const
+    {
+        if (std::binary_search(states_.begin(), states_.end(), state)) {return true;}
+
+        std::lock_guard<std::mutex> lock(io_);
+        std::vector<PackedCube> block;
+
+        for (const SpillRun& run : runs_)
+        {
+            regi b = blockOf(run, state);
+
+            if (b == run.index.size()) {continue;}
+            if (run.index[b] == state) {return true;}
+
+            readBlock(run, b, block);
+
+            if (std::binary_search(block.begin(), block.end(), state)) {return true;}
+        }
+
+        return false;
+    }
+
+    regi PackedStateSet::size() const noexcept {return spilled_ + states_.size();}
+    regi PackedStateSet::spilled() const noexcept {return spilled_;}
+
+    void PackedStateSet::forEach(const std::function<void(const PackedCube&)>& visit) const
+    {
+        if (runs_.empty())
+        {
+            for (const PackedCube& s : states_) {visit(s);}
+
+            return;
+        }
+
+        // Merge of the runs and the in-memory states, taking the least head each step.
+        regi n = runs_.size();
+        std::vector<SpillReader> readers;
+        std::vector<PackedCube> heads(n);
+        std::vector<bool> more(n);
+        regi i = 0;
+
+        readers.reserve(n);
+
+        for (regi r = 0; r < n; ++r)
+        {
+            readers.emplace_back(runs_[r].path);
+            more[r] = readers[r].next(heads[r]);
+        }
+
+        while (true)
+        {
+            const PackedCube* least = i < states_.size() ? &states_[i] : nullptr;
+            regi from = n;
+
+            for (regi r = 0; r < n; ++r)
+            {
+                if (more[r] && (!least || heads[r] < *least)) {least = &heads[r]; from = r;}
+            }
+
+            if (!least) {return;}
+
+            visit(*least);
+
+            if (from == n) {++i;}
+            else {more[from] = readers[from].next(heads[from]);}
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Packed.hpp"
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace slvr
+{
+    // Deduplication of large scramble corpora on ranked states. A cube has about 4.3e19 states,
+    // which is more than 64 bits can index, so keys are PackedCube ranks (27 bits of corners and 40
+    // of edges, 12 bytes on disk). Batches are sorted with a parallel LSD radix sort over those 67
+    // bits and deduplicated in parallel before being merged into the set.
+    struct StateSetConfig
+    {
+        regi threads = std::thread::hardware_concurrency();
+        regi ramLimit = regi(1) << 30;  // bytes of states kept in memory before spilling
+        std::string spillPath;          // prefix of the spill run files; empty keeps everything in memory
+    };
+
+    // Inputs collapsed to their distinct states. unique is in order of first appearance and
+    // representative[i] is the position of inputs[i] in it.
+    struct Dedup
+    {
+        std::vector<PackedCube> unique;
+        std::vector<regi> representative;
+    };
+
+    [[nodiscard]] Dedup dedup(const std::vector<PackedCube>& inputs, regi threads = std::thread::hardware_concurrency());
+    [[nodiscard]] Dedup dedup(const std::vector<Cube>& inputs, regi threads = std::thread::hardware_concurrency());
+
+    // Sorts states and removes duplicates in place.
+    void sortUnique(std::vector<PackedCube>& states, regi threads = std::thread::hardware_concurrency());
+
+    // Sorted run of states on disk, with the first key of every block kept in memory so a lookup
+    // reads a single block.
+    struct SpillRun
+    {
+        std::string path;
+        regi size;
+        std::vector<PackedCube> index;
+        mutable std::ifstream in;
+    };
+
+    // Sorted set of distinct packed states. Once the in-memory part passes the RAM limit it is written
+    // out as a new run. A run is merged into the one before it once it is as large, so there are
+    // O(log n) runs and each spilled state is rewritten O(log n) times.
+    class PackedStateSet
+    {
+    private:
+        StateSetConfig config_;
+        std::vector<PackedCube> states_;  // sorted, distinct and absent from every run
+        std::vector<SpillRun> runs_;      // disjoint, oldest first
+        regi spilled_;                    // states in runs
+        regi nextRun_;                    // suffix of the next run file
+        mutable std::mutex io_;           // guards the runs' streams
+
+        [[nodiscard]] std::string runPath();
+        void spill();
+        void compact();
+
+    public:
+        explicit PackedStateSet(StateSetConfig config = {});
+        PackedStateSet(const PackedStateSet&) = delete;
+        PackedStateSet& operator=(const PackedStateSet&) = delete;
+        ~PackedStateSet();
+
+        // Bulk insert; returns how many of the states were new.
+        regi insert(std::vector<PackedCube> states);
+        regi insert(const std::vector<Cube>& cubes);
+
+        // Binary search in memory, then in one block of each run.
+        [[nodiscard]] bool contains(const PackedCube& state) const;
+
+        [[nodiscard]] regi size() const noexcept;
+        [[nodiscard]] regi spilled() const noexcept;
+
+        // Every state in ascending order, streaming from disk where spilled.
+        void forEach(const std::function<void(const PackedCube&)>& visit) const;
+    };
+}
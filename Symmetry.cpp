@@ -0,0 +1,334 @@
+#include "Symmetry.hpp"
+#include <algorithm>
+
+namespace slvr
+{
+    namespace sym
+    {
+        using Vec = std::array<int, 3>;
+        using Stickers = std::array<byte, 48>;
+
+        // Slot coordinates with x towards R, y towards U and z towards F, in the order Cube uses.
+        static constexpr const std::array<Vec,  8> cornerSlots {{{ 1, 1,-1}, { 1, 1, 1}, {-1, 1, 1}, {-1, 1,-1},
+                                                                 { 1,-1,-1}, { 1,-1, 1}, {-1,-1, 1}, {-1,-1,-1}}};
+
+        static constexpr const std::array<Vec, 12> edgeSlots {{{ 0, 1,-1}, { 1, 1, 0}, { 0, 1, 1}, {-1, 1, 0},
+                                                               { 1, 0,-1}, { 1, 0, 1}, {-1, 0, 1}, {-1, 0,-1},
+                                                               { 0,-1,-1}, { 1,-1, 0}, { 0,-1, 1}, {-1,-1, 0}}};
+
+        struct Symmetry
+        {
+            std::array<byte, 3> axis;
+            std::array<int,  3> sign;
+
+            [[nodiscard]] Vec apply(const Vec& v) const noexcept
+            {
+                return Vec{sign[0] * v[axis[0]], sign[1] * v[axis[1]], sign[2] * v[axis[2]]};
+            }
+        };
+
+        struct Tables
+        {
+            std::array<Symmetry, numSymmetries> syms;
+            std::array<Vec, 48> position;
+            std::array<Vec, 48> normal;
+            std::array<std::array<byte, 48>, numSymmetries> location;
+            std::array<std::array<Move, 18>, numSymmetries> moves;
+            std::array<std::array<byte, numSymmetries>, numSymmetries> product;
+            std::array<byte, numSymmetries> inverse;
+            std::array<bool, numSymmetries> mirror;
+            std::array<byte, 3> diagonal;
+        };
+
+        static int determinant(const Vec& a, const Vec& b, const Vec& c) noexcept
+        {
+            return a[0] * (b[1] * c[2] - b[2] * c[1])
+                 - a[1] * (b[0] * c[2] - b[2] * c[0])
+                 + a[2] * (b[0] * c[1] - b[1] * c[0]);
+        }
+
+        // Sticker k of a slot is k steps clockwise from its reference sticker, which faces U or D
+        // (or F or B for the middle-layer edges) when the piece is oriented.
+        static void buildStickers(Tables& t)
+        {
+            for (byte s = 0; s < 8; ++s)
+            {
+                const Vec& p = cornerSlots[s];
+                Vec ref{0, p[1], 0}, a{p[0], 0, 0}, b{0, 0, p[2]};
+
+                if (determinant(ref, a, b) > 0) {std::swap(a, b);}
+
+                t.normal[3 * s] = ref;
+                t.normal[3 * s + 1] = a;
+                t.normal[3 * s + 2] = b;
+
+                for (byte k = 0; k < 3; ++k) {t.position[3 * s + k] = p;}
+            }
+
+            for (byte e = 0; e < 12; ++e)
+            {
+                const Vec& p = edgeSlots[e];
+                Vec ref = p[1] ? Vec{0, p[1], 0} : Vec{0, 0, p[2]};
+                Vec other = p[0] ? Vec{p[0], 0, 0} : Vec{0, 0, p[2]};
+
+                t.normal[24 + 2 * e] = ref;
+                t.normal[25 + 2 * e] = other;
+                t.position[24 + 2 * e] = p;
+                t.position[25 + 2 * e] = p;
+            }
+        }
+
+        static void buildSymmetries(Tables& t)
+        {
+            std::array<byte, 3> axis{0, 1, 2};
+            byte n = 0;
+
+            do
+            {
+                for (byte signs = 0; signs < 8; ++signs)
+                {
+                    t.syms[n++] = Symmetry{axis, {signs & 1 ? -1 : 1, signs & 2 ? -1 : 1, signs & 4 ? -1 : 1}};
+                }
+            }
+            while (std::next_permutation(axis.begin(), axis.end()));
+
+            auto find = [&t](const Vec& x, const Vec& y, const Vec& z)
+            {
+                for (byte s = 0; s < numSymmetries; ++s)
+                {
+                    const Symmetry& m = t.syms[s];
+
+                    if (m.apply({1, 0, 0}) == x && m.apply({0, 1, 0}) == y && m.apply({0, 0, 1}) == z) {return s;}
+                }
+
+                return identity;
+            };
+
+            for (byte s = 0; s < numSymmetries; ++s)
+            {
+                const Symmetry& a = t.syms[s];
+
+                t.mirror[s] = determinant(a.apply({1, 0, 0}), a.apply({0, 1, 0}), a.apply({0, 0, 1})) < 0;
+
+                for (byte r = 0; r < numSymmetries; ++r)
+                {
+                    const Symmetry& b = t.syms[r];
+
+                    t.product[s][r] = find(a.apply(b.apply({1, 0, 0})), a.apply(b.apply({0, 1, 0})), a.apply(b.apply({0, 0, 1})));
+                }
+
+                for (byte l = 0; l < 48; ++l)
+                {
+                    Vec p = a.apply(t.position[l]), q = a.apply(t.normal[l]);
+
+                    for (byte m = 0; m < 48; ++m)
+                    {
+                        if (t.position[m] == p && t.normal[m] == q) {t.location[s][l] = m; break;}
+                    }
+                }
+            }
+
+            for (byte s = 0; s < numSymmetries; ++s)
+            {
+                for (byte r = 0; r < numSymmetries; ++r)
+                {
+                    if (t.product[s][r] == identity) {t.inverse[s] = r;}
+                }
+            }
+
+            t.diagonal = {identity, find({0, 1, 0}, {0, 0, 1}, {1, 0, 0}), find({0, 0, 1}, {1, 0, 0}, {0, 1, 0})};
+        }
+
+        static Stickers toStickers(const Cube& cube) noexcept
+        {
+            Stickers st;
+
+            for (byte s = 0; s < 8; ++s)
+            {
+                byte q = cube.cornerPositions()[s], o = cube.cornerOrientations()[s];
+
+                for (byte k = 0; k < 3; ++k) {st[3 * s + k] = static_cast<byte>(3 * q + (k + o) % 3);}
+            }
+
+            for (byte e = 0; e < 12; ++e)
+            {
+                byte q = cube.edgePositions()[e], o = cube.edgeOrientations()[e];
+
+                for (byte k = 0; k < 2; ++k) {st[24 + 2 * e + k] = static_cast<byte>(24 + 2 * q + (k ^ o));}
+            }
+
+            return st;
+        }
+
+        static Cube fromStickers(const Stickers& st)
+        {
+            corner_arr cp, co;
+            edge_arr ep, eo;
+
+            for (byte s = 0; s < 8; ++s)
+            {
+                cp[s] = st[3 * s] / 3;
+                co[s] = st[3 * s] % 3;
+            }
+
+            for (byte e = 0; e < 12; ++e)
+            {
+                ep[e] = (st[24 + 2 * e] - 24) / 2;
+                eo[e] = (st[24 + 2 * e] - 24) % 2;
+            }
+
+            return Cube(cp, co, ep, eo);
+        }
+
+        static Cube conjugate(const Tables& t, const Cube& cube, byte s)
+        {
+            const std::array<byte, 48>& loc = t.location[s];
+            Stickers st = toStickers(cube), out;
+
+            for (byte l = 0; l < 48; ++l) {out[loc[l]] = loc[st[l]];}
+
+            return fromStickers(out);
+        }
+
+        static void buildMoves(Tables& t)
+        {
+            std::array<Cube, 18> single;
+
+            for (byte m = 0; m < 18; ++m) {single[m].applyMove(static_cast<Move>(m));}
+
+            for (byte s = 0; s < numSymmetries; ++s)
+            {
+                for (byte m = 0; m < 18; ++m)
+                {
+                    Cube c = conjugate(t, single[m], s);
+
+                    t.moves[s][m] = static_cast<Move>(std::find(single.begin(), single.end(), c) - single.begin());
+                }
+            }
+        }
+
+        static const Tables& tables()
+        {
+            static const Tables t = []
+            {
+                Tables t;
+
+                buildStickers(t);
+                buildSymmetries(t);
+                buildMoves(t);
+
+                return t;
+            }();
+
+            return t;
+        }
+
+        byte inverse(byte s) noexcept {return tables().inverse[s];}
+
+        byte compose(byte a, byte b) noexcept {return tables().product[a][b];}
+
+        bool isMirror(byte s) noexcept {return tables().mirror[s];}
+
+        byte axisRotation(byte k) noexcept {return tables().diagonal[k % 3];}
+
+        Cube conjugate(const Cube& cube, byte s) {return conjugate(tables(), cube, s);}
+
+        Move conjugate(Move move, byte s) noexcept
+        {
+            if (move == Move::NULL_MOVE) {return move;}
+
+            return tables().moves[s][static_cast<byte>(move)];
+        }
+
+        std::vector<Move> conjugate(const std::vector<Move>& moves, byte s)
+        {
+            std::vector<Move> out;
+            out.reserve(moves.size());
+
+            for (Move move : moves) {out.push_back(conjugate(move, s));}
+
+            return out;
+        }
+
+        Cube inverse(const Cube& cube)
+        {
+            corner_arr cp, co;
+            edge_arr ep, eo;
+
+            for (byte s = 0; s < 8; ++s)
+            {
+                byte q = cube.cornerPositions()[s];
+
+                cp[q] = s;
+                co[q] = (3 - cube.cornerOrientations()[s]) % 3;
+            }
+
+            for (byte e = 0; e < 12; ++e)
+            {
+                byte q = cube.edgePositions()[e];
+
+                ep[q] = e;
+                eo[q] = cube.edgeOrientations()[e];
+            }
+
+            return Cube(cp, co, ep, eo);
+        }
+
+        Move inverse(Move move) noexcept
+        {
+            if (move == Move::NULL_MOVE) {return move;}
+
+            byte num = static_cast<byte>(move);
+
+            switch (num % 3)
+            {
+                case 0: return static_cast<Move>(num + 1);
+                case 1: return static_cast<Move>(num - 1);
+                default: return move;
+            }
+        }
+
+        std::vector<Move> inverse(const std::vector<Move>& moves)
+        {
+            std::vector<Move> out;
+            out.reserve(moves.size());
+
+            for (auto it = moves.rbegin(); it != moves.rend(); ++it) {out.push_back(inverse(*it));}
+
+            return out;
+        }
+
+        Canonical canonical(const Cube& cube)
+        {
+            const Tables& t = tables();
+            const Cube inv = inverse(cube);
+            Canonical best;
+
+            best.state = pack(cube);
+
+            for (byte s = 0; s < numSymmetries; ++s)
+            {
+                for (bool inverted : {false, true})
+                {
+                    PackedCube p = pack(conjugate(t, inverted ? inv : cube, s));
+
+                    if (p < best.state) {best = Canonical{p, s, inverted};}
+                }
+            }
+
+            return best;
+        }
+
+        std::vector<Move> fromCanonical(const std::vector<Move>& solution, const Canonical& canon)
+        {
+            std::vector<Move> moves = conjugate(solution, inverse(canon.symmetry));
+
+            return canon.inverted ? inverse(moves) : moves;
+        }
+
+        std::vector<Move> toCanonical(const std::vector<Move>& solution, const Canonical& canon)
+        {
+            return conjugate(canon.inverted ? inverse(solution) : solution, canon.symmetry);
+        }
+    }
+}
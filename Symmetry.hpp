@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Packed.hpp"
+
+namespace slvr
+{
+    // The 48 symmetries of the cube (24 rotations and their mirror images), applied by conjugation.
+    // Conjugation is an automorphism, so a solution of conjugate(c, s) mapped through inverse(s)
+    // solves c.
+    namespace sym
+    {
+        constexpr const byte numSymmetries = 48;
+        constexpr const byte identity      = 0;
+
+        [[nodiscard]] byte inverse(byte s) noexcept;
+        [[nodiscard]] byte compose(byte a, byte b) noexcept;
+        [[nodiscard]] bool isMirror(byte s) noexcept;
+
+        // Rotation by k * 120 degrees about the URF-DBL diagonal, which cycles the R, U and F axes.
+        [[nodiscard]] byte axisRotation(byte k) noexcept;
+
+        [[nodiscard]] Cube conjugate(const Cube& cube, byte s);
+        [[nodiscard]] Move conjugate(Move move, byte s) noexcept;
+        [[nodiscard]] std::vector<Move> conjugate(const std::vector<Move>& moves, byte s);
+
+        [[nodiscard]] Cube inverse(const Cube& cube);
+        [[nodiscard]] Move inverse(Move move) noexcept;
+        [[nodiscard]] std::vector<Move> inverse(const std::vector<Move>& moves);
+
+        struct Canonical
+        {
+            PackedCube state;
+            byte symmetry = identity;
+            bool inverted = false;
+        };
+
+        [[nodiscard]] Canonical canonical(const Cube& cube);
+
+        // Maps a solution of the canonical state back to a solution of the original cube, and back again.
+        [[nodiscard]] std::vector<Move> fromCanonical(const std::vector<Move>& solution, const Canonical& canon);
+        [[nodiscard]] std::vector<Move> toCanonical(const std::vector<Move>& solution, const Canonical& canon);
+    }
+}
@@ -0,0 +1,256 @@
+#ifdef SLVR_ENABLE_TRACE
+
+#include "Trace.hpp"
+#include <array>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#define TRACE_FILE "Could not write trace file"
+
+namespace slvr
+{
+    namespace trace
+    {
+        // An Event whose fields can be read while the ring's writer overwrites them.
+        struct Slot
+        {
+            std::atomic<const char*> name{nullptr};
+            std::atomic<std::uint64_t> begin{0};
+            std::atomic<std::uint64_t> duration{0};
+            std::atomic<std::int64_t> arg{0};
+            std::atomic<std::uint32_t> tid{0};
+            std::atomic<char> phase{0};
+        };
+
+        // head only grows within a generation. clear() bumps the registry's generation and each
+        // writer empties its own ring when it next records; collect() skips rings not yet emptied.
+        struct Ring
+        {
+            std::array<Slot, ringCapacity> events;
+            std::atomic<std::uint64_t> head{0};
+            std::atomic<std::uint64_t> generation{0};
+        };
+
+        struct Registry
+        {
+            std::mutex mtx;
+            std::vector<std::unique_ptr<Ring>> rings;
+            std::vector<Ring*> spare;
+            std::atomic<bool> recording{false};
+            std::atomic<std::uint32_t> nextTid{1};
+            std::atomic<std::uint64_t> generation{0};
+            const Clock::time_point epoch = Clock::now();
+        };
+
+        static Registry& registry()
+        {
+            static Registry r;
+
+            return r;
+        }
+
+        // A thread takes a ring on its first event and hands it back on exit. The handover goes
+        // through the registry mutex, so a ring only ever has one writer.
+        struct Writer
+        {
+            Ring* ring = nullptr;
+            std::uint32_t tid = 0;
+
+            Ring& acquire()
+            {
+                if (ring) {return *ring;}
+
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mtx);
+
+                tid = r.nextTid.fetch_add(1, std::memory_order_relaxed);
+
+                if (!r.spare.empty())
+                {
+                    ring = r.spare.back();
+                    r.spare.pop_back();
+                }
+                else
+                {
+                    r.rings.push_back(std::make_unique<Ring>());
+                    ring = r.rings.back().get();
+                    ring->generation.store(r.generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+
+                return *ring;
+            }
+
+            ~Writer()
+            {
+                if (!ring) {return;}
+
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mtx);
+
+                r.spare.push_back(ring);
+            }
+        };
+
+        static thread_local Writer writer;
+
+        void start() noexcept {registry().recording.store(true, std::memory_order_relaxed);}
+        void stop() noexcept  {registry().recording.store(false, std::memory_order_relaxed);}
+
+        void clear()
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+
+            r.generation.fetch_add(1, std::memory_order_release);
+
+            // Spare rings have no writer to empty them.
+            for (Ring* ring : r.spare)
+            {
+                ring->head.store(0, std::memory_order_relaxed);
+                ring->generation.store(r.generation.load(std::memory_order_relaxed), std::memory_order_release);
+            }
+        }
+
+        bool recording() noexcept {return registry().recording.load(std::memory_order_relaxed);}
+
+        std::uint64_t now() noexcept
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - registry().epoch).count());
+        }
+
+        void record(const Event& event) noexcept
+        {
+            Ring& ring = writer.acquire();
+            std::uint64_t generation = registry().generation.load(std::memory_order_acquire);
+
+            if (ring.generation.load(std::memory_order_relaxed) != generation)
+            {
+                ring.head.store(0, std::memory_order_relaxed);
+                ring.generation.store(generation, std::memory_order_release);
+            }
+
+            std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+            Slot& slot = ring.events[head % ringCapacity];
+
+            // Orders the head published last time before the slot is overwritten, for collect().
+            std::atomic_thread_fence(std::memory_order_release);
+
+            slot.name.store(event.name, std::memory_order_relaxed);
+            slot.begin.store(event.begin, std::memory_order_relaxed);
+            slot.duration.store(event.duration, std::memory_order_relaxed);
+            slot.arg.store(event.arg, std::memory_order_relaxed);
+            slot.tid.store(writer.tid, std::memory_order_relaxed);
+            slot.phase.store(event.phase, std::memory_order_relaxed);
+            ring.head.store(head + 1, std::memory_order_release);
+        }
+
+        void instant(const char* name, std::int64_t arg) noexcept
+        {
+            if (!recording()) {return;}
+
+            record(Event{name, now(), 0, arg, 0, 'i'});
+        }
+
+        Span::Span(const char* name, std::int64_t arg) noexcept :
+            name_(name),
+            arg_(arg),
+            begin_(0),
+            active_(recording())
+        {
+            if (active_) {begin_ = now();}
+        }
+
+        Span::~Span()
+        {
+            if (!active_ || !recording()) {return;}
+
+            record(Event{name_, begin_, now() - begin_, arg_, 0, 'X'});
+        }
+
+        static Event load(const Slot& slot) noexcept
+        {
+            return Event{slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed),
+                         slot.duration.load(std::memory_order_relaxed), slot.arg.load(std::memory_order_relaxed),
+                         slot.tid.load(std::memory_order_relaxed), slot.phase.load(std::memory_order_relaxed)};
+        }
+
+        // Reads a ring while its owner may still be writing: the head is read before and after the
+        // copy, and slots the writer may have reused in between, including the one it may be writing
+        // now, are discarded. Rings left over from before the last clear() are skipped.
+        static void collect(const Ring& ring, std::uint64_t generation, std::vector<Event>& out)
+        {
+            if (ring.generation.load(std::memory_order_acquire) != generation) {return;}
+
+            std::uint64_t before = ring.head.load(std::memory_order_acquire);
+            std::uint64_t first = before > ringCapacity ? before - ringCapacity : 0;
+            regi start = out.size();
+
+            for (std::uint64_t i = first; i < before; ++i) {out.push_back(load(ring.events[i % ringCapacity]));}
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            std::uint64_t after = ring.head.load(std::memory_order_relaxed);
+            std::uint64_t valid = after + 1 > ringCapacity ? after + 1 - ringCapacity : 0;
+
+            if (valid > first)
+            {
+                regi stale = static_cast<regi>(std::min(valid, before) - first);
+
+                out.erase(out.begin() + static_cast<std::ptrdiff_t>(start), out.begin() + static_cast<std::ptrdiff_t>(start + stale));
+            }
+        }
+
+        std::string json()
+        {
+            std::vector<Event> events;
+
+            {
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mtx);
+
+                std::uint64_t generation = r.generation.load(std::memory_order_acquire);
+
+                for (const auto& ring : r.rings) {collect(*ring, generation, events);}
+            }
+
+            std::ostringstream os;
+
+            os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+            for (regi i = 0; i < events.size(); ++i)
+            {
+                const Event& e = events[i];
+
+                os << (i ? "," : "")
+                   << "{\"name\":\"" << e.name << "\",\"ph\":\"" << e.phase
+                   << "\",\"pid\":1,\"tid\":" << e.tid
+                   << ",\"ts\":" << e.begin / 1000 << '.' << e.begin % 1000 / 100 << e.begin % 100 / 10 << e.begin % 10;
+
+                if (e.phase == 'X') {os << ",\"dur\":" << e.duration / 1000 << '.' << e.duration % 1000 / 100 << e.duration % 100 / 10 << e.duration % 10;}
+                else                {os << ",\"s\":\"t\"";}
+
+                os << ",\"args\":{\"value\":" << e.arg << "}}";
+            }
+
+            os << "]}";
+
+            return os.str();
+        }
+
+        void dump(const std::string& path)
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+            if (!out) {throw std::runtime_error(TRACE_FILE);}
+
+            out << json();
+
+            if (!out) {throw std::runtime_error(TRACE_FILE);}
+        }
+    }
+}
+
+#endif
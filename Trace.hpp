@@ -0,0 +1,73 @@
+#pragma once
+
+// Search timeline capture in Chrome trace format (chrome://tracing, ui.perfetto.dev). Compiled out
+// unless SLVR_ENABLE_TRACE is defined: the macros below then expand to nothing.
+
+#ifdef SLVR_ENABLE_TRACE
+
+#include "SearchControl.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace slvr
+{
+    namespace trace
+    {
+        struct Event
+        {
+            const char* name;
+            std::uint64_t begin;     // ns since the trace epoch
+            std::uint64_t duration;  // ns, spans only
+            std::int64_t arg;
+            std::uint32_t tid;
+            char phase;              // 'X' complete span, 'i' instant
+        };
+
+        // Events per ring. Each thread writes to its own ring without locking; rings of finished
+        // threads are reused, so memory is bounded by the number of threads alive at once.
+        constexpr const regi ringCapacity = 8192;
+
+        // Recording is off until start(), so a traced build only pays for the check.
+        void start() noexcept;
+        void stop() noexcept;
+        void clear();
+
+        [[nodiscard]] bool recording() noexcept;
+        [[nodiscard]] std::uint64_t now() noexcept;
+
+        void record(const Event& event) noexcept;
+        void instant(const char* name, std::int64_t arg = 0) noexcept;
+
+        // Recorded events as a Chrome trace JSON object. Events overwritten while being read are dropped.
+        [[nodiscard]] std::string json();
+        void dump(const std::string& path);
+
+        class Span
+        {
+        private:
+            const char* name_;
+            std::int64_t arg_;
+            std::uint64_t begin_;
+            bool active_;
+
+        public:
+            explicit Span(const char* name, std::int64_t arg = 0) noexcept;
+            Span(const Span&) = delete;
+            Span& operator=(const Span&) = delete;
+            ~Span();
+        };
+    }
+}
+
+#define SLVR_TRACE_CONCAT_(a, b) a##b
+#define SLVR_TRACE_CONCAT(a, b) SLVR_TRACE_CONCAT_(a, b)
+#define SLVR_TRACE_SPAN(...) const ::slvr::trace::Span SLVR_TRACE_CONCAT(slvrTraceSpan, __LINE__)(__VA_ARGS__)
+#define SLVR_TRACE_INSTANT(...) ::slvr::trace::instant(__VA_ARGS__)
+
+#else
+
+#define SLVR_TRACE_SPAN(...) static_cast<void>(0)
+#define SLVR_TRACE_INSTANT(...) static_cast<void>(0)
+
+#endif